@@ -236,8 +236,8 @@ static constexpr auto ZIF_GIT_BLOB_LOOKUP_PREFIX = zif_php_git2_function_setdeps
         php_git2::php_resource_ref<php_git2::php_git_blob>,
         php_git2::php_resource<php_git2::php_git_repository>,
         php_git2::connector_wrapper<php_git2::php_string_length_connector<
-                                        size_t,php_git2::php_git_oid_fromstr> >,
-        php_git2::php_git_oid_fromstr
+                                        size_t,php_git2::php_git_oid_prefix_fromhex> >,
+        php_git2::php_git_oid_prefix_fromhex
         >,
     php_git2::sequence<0,1>,
     1,
@@ -329,6 +329,44 @@ static constexpr auto ZIF_GIT_BLOB_CREATE_FROMSTREAM_COMMIT = zif_php_git2_funct
     php_git2::sequence<0,1>
     >;
 
+static PHP_FUNCTION(git2_blob_stream)
+{
+    php_git2::php_bailer bailer;
+
+    {
+        php_git2::php_resource<php_git2::php_git_blob> blob;
+        php_git2::php_bailout_context ctx(bailer);
+
+        if (BAILOUT_ENTER_REGION(ctx)) {
+            zval* zvp;
+            php_stream* stream;
+            if (zend_parse_parameters(ZEND_NUM_ARGS(),"z",&zvp) == FAILURE) {
+                return;
+            }
+
+            try {
+                blob.parse(zvp,1);
+
+                // The stream holds a reference to the blob resource so that the
+                // blob buffer remains valid while the stream is open.
+                stream = php_git2::php_git2_make_blob_stream(zvp,blob.byval_git2());
+                if (stream == nullptr) {
+                    RETURN_FALSE;
+                }
+
+                php_stream_to_zval(stream,return_value);
+
+            } catch (php_git2::php_git2_exception_base& ex) {
+                php_git2::php_bailout_context ctx2(bailer);
+
+                if (BAILOUT_ENTER_REGION(ctx2)) {
+                    ex.handle();
+                }
+            }
+        }
+    }
+}
+
 #define GIT_BLOB_FE                                                     \
     PHP_GIT2_FE(git_blob_create_frombuffer,ZIF_GIT_BLOB_CREATE_FROMBUFFER,NULL) \
     PHP_GIT2_FE(git_blob_create_fromdisk,ZIF_GIT_BLOB_CREATE_FROMDISK,NULL) \
@@ -344,7 +382,8 @@ static constexpr auto ZIF_GIT_BLOB_CREATE_FROMSTREAM_COMMIT = zif_php_git2_funct
     PHP_GIT2_FE(git_blob_rawsize,ZIF_GIT_BLOB_RAWSIZE,NULL)             \
     PHP_GIT2_FE(git_blob_dup,ZIF_GIT_BLOB_DUP,NULL)                     \
     PHP_GIT2_FE(git_blob_create_fromstream,ZIF_GIT_BLOB_CREATE_FROMSTREAM,NULL) \
-    PHP_GIT2_FE(git_blob_create_fromstream_commit,ZIF_GIT_BLOB_CREATE_FROMSTREAM_COMMIT,NULL)
+    PHP_GIT2_FE(git_blob_create_fromstream_commit,ZIF_GIT_BLOB_CREATE_FROMSTREAM_COMMIT,NULL) \
+    PHP_FE(git2_blob_stream,NULL)
 
 /*
  * Local Variables:
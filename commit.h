@@ -29,6 +29,84 @@ namespace php_git2
             >
         >;
 
+    // Looks up, converts and frees each commit in a list of OIDs. This is the
+    // implementation of git2_commit_info_many(). Author/committer names and
+    // emails are shared between entries via a per-call string table.
+
+    inline void php_git2_commit_info_many(zval* return_value,
+        git_repository* repo,
+        zval* zoids,
+        zend_long fields,
+        bool columnar)
+    {
+        HashTable* oids = Z_ARRVAL_P(zoids);
+        HashTable strings;
+        zval* zoid;
+
+        zend_hash_init(&strings,32,nullptr,ZVAL_PTR_DTOR,0);
+
+        array_init_size(return_value,columnar ? 10 : zend_hash_num_elements(oids));
+
+        try {
+            ZEND_HASH_FOREACH_VAL(oids,zoid) {
+                int retval;
+                git_oid oid;
+                git_commit* commit;
+                zval zinfo;
+
+                ZVAL_DEREF(zoid);
+
+                if (Z_TYPE_P(zoid) != IS_STRING
+                    || convert_oid_fromstr(&oid,Z_STRVAL_P(zoid),Z_STRLEN_P(zoid)) < 0)
+                {
+                    throw php_git2_error_exception("Array element is not a valid OID");
+                }
+
+                retval = git_commit_lookup(&commit,repo,&oid);
+                if (retval < 0) {
+                    git_error(retval);
+                }
+
+                convert_commit_info(&zinfo,commit,fields,&strings);
+                git_commit_free(commit);
+
+                if (!columnar) {
+                    add_next_index_zval(return_value,&zinfo);
+                    continue;
+                }
+
+                // In columnar mode, each field is appended to a list stored
+                // under the field key.
+
+                zend_string* key;
+                zval* zvalue;
+
+                ZEND_HASH_FOREACH_STR_KEY_VAL(Z_ARRVAL(zinfo),key,zvalue) {
+                    zval* zcolumn;
+
+                    zcolumn = zend_hash_find(Z_ARRVAL_P(return_value),key);
+                    if (zcolumn == nullptr) {
+                        zval znew;
+
+                        array_init_size(&znew,zend_hash_num_elements(oids));
+                        zcolumn = zend_hash_add_new(Z_ARRVAL_P(return_value),key,&znew);
+                    }
+
+                    Z_TRY_ADDREF_P(zvalue);
+                    add_next_index_zval(zcolumn,zvalue);
+                } ZEND_HASH_FOREACH_END();
+
+                zval_ptr_dtor(&zinfo);
+            } ZEND_HASH_FOREACH_END();
+
+        } catch (...) {
+            zend_hash_destroy(&strings);
+            throw;
+        }
+
+        zend_hash_destroy(&strings);
+    }
+
 } // php_git2
 
 // Functions:
@@ -61,8 +139,8 @@ static constexpr auto ZIF_GIT_COMMIT_LOOKUP_PREFIX = zif_php_git2_function_setde
         php_git2::php_resource_ref<php_git2::php_git_commit>,
         php_git2::php_resource<php_git2::php_git_repository>,
         php_git2::connector_wrapper<
-            php_git2::php_string_length_connector<size_t,php_git2::php_git_oid_fromstr> >,
-        php_git2::php_git_oid_fromstr
+            php_git2::php_string_length_connector<size_t,php_git2::php_git_oid_prefix_fromhex> >,
+        php_git2::php_git_oid_prefix_fromhex
         >,
     php_git2::sequence<0,1>,
     1,
@@ -522,6 +600,111 @@ static constexpr auto ZIF_GIT_COMMIT_HEADER_FIELD = zif_php_git2_function<
     php_git2::sequence<0,1,2>
     >;
 
+static PHP_FUNCTION(git2_commit_info)
+{
+    php_git2::php_bailer bailer;
+
+    {
+        php_git2::php_resource<php_git2::php_git_commit> commit;
+        php_git2::php_resource<php_git2::php_git_repository> repo;
+        php_git2::php_bailout_context ctx(bailer);
+
+        if (BAILOUT_ENTER_REGION(ctx)) {
+            zval* zfirst;
+            zval* zsecond = nullptr;
+            zend_long fields = GIT2_COMMIT_INFO_ALL;
+            if (zend_parse_parameters(ZEND_NUM_ARGS(),"z|z!l",&zfirst,&zsecond,&fields) == FAILURE) {
+                return;
+            }
+
+            try {
+                // Accept either (git_commit $commit [, int $fields]) or
+                // (git_repository $repo, string $oid [, int $fields]).
+
+                if (Z_TYPE_P(zfirst) == IS_RESOURCE
+                    && Z_RES_TYPE_P(zfirst) == php_git2::php_git_commit::resource_le())
+                {
+                    if (zsecond != nullptr) {
+                        if (Z_TYPE_P(zsecond) != IS_LONG || ZEND_NUM_ARGS() > 2) {
+                            throw php_git2::php_git2_error_exception(
+                                "Expected fields bitmask as second argument");
+                        }
+
+                        fields = Z_LVAL_P(zsecond);
+                    }
+
+                    commit.parse(zfirst,1);
+                    php_git2::convert_commit_info(return_value,commit.byval_git2(),fields);
+                }
+                else {
+                    int retval;
+                    git_oid oid;
+                    git_commit* handle;
+
+                    repo.parse(zfirst,1);
+                    if (zsecond == nullptr || Z_TYPE_P(zsecond) != IS_STRING
+                        || php_git2::convert_oid_fromstr(&oid,Z_STRVAL_P(zsecond),Z_STRLEN_P(zsecond)) < 0)
+                    {
+                        throw php_git2::php_git2_error_exception(
+                            "Expected commit OID as second argument");
+                    }
+
+                    retval = git_commit_lookup(&handle,repo.byval_git2(),&oid);
+                    if (retval < 0) {
+                        php_git2::git_error(retval);
+                    }
+
+                    php_git2::convert_commit_info(return_value,handle,fields);
+                    git_commit_free(handle);
+                }
+
+            } catch (php_git2::php_git2_exception_base& ex) {
+                php_git2::php_bailout_context ctx2(bailer);
+
+                if (BAILOUT_ENTER_REGION(ctx2)) {
+                    ex.handle();
+                }
+            }
+        }
+    }
+}
+
+static PHP_FUNCTION(git2_commit_info_many)
+{
+    php_git2::php_bailer bailer;
+
+    {
+        php_git2::php_resource<php_git2::php_git_repository> repo;
+        php_git2::php_bailout_context ctx(bailer);
+
+        if (BAILOUT_ENTER_REGION(ctx)) {
+            zval* zrepo;
+            zval* zoids;
+            zend_long fields = GIT2_COMMIT_INFO_ALL;
+            zend_bool columnar = 0;
+            if (zend_parse_parameters(ZEND_NUM_ARGS(),"za|lb",&zrepo,&zoids,&fields,&columnar) == FAILURE) {
+                return;
+            }
+
+            try {
+                repo.parse(zrepo,1);
+                php_git2::php_git2_commit_info_many(return_value,
+                    repo.byval_git2(),
+                    zoids,
+                    fields,
+                    columnar);
+
+            } catch (php_git2::php_git2_exception_base& ex) {
+                php_git2::php_bailout_context ctx2(bailer);
+
+                if (BAILOUT_ENTER_REGION(ctx2)) {
+                    ex.handle();
+                }
+            }
+        }
+    }
+}
+
 // Function Entries:
 
 #define GIT_COMMIT_FE                                                   \
@@ -554,7 +737,9 @@ static constexpr auto ZIF_GIT_COMMIT_HEADER_FIELD = zif_php_git2_function<
     PHP_GIT2_FE(git_commit_amend,ZIF_GIT_COMMIT_AMEND,NULL)             \
     PHP_GIT2_FE(git_commit_dup,ZIF_GIT_COMMIT_DUP,NULL)                 \
     PHP_GIT2_FE(git_commit_extract_signature,ZIF_GIT_COMMIT_EXTRACT_SIGNATURE,git_commit_extract_signature_arginfo) \
-    PHP_GIT2_FE(git_commit_header_field,ZIF_GIT_COMMIT_HEADER_FIELD,NULL)
+    PHP_GIT2_FE(git_commit_header_field,ZIF_GIT_COMMIT_HEADER_FIELD,NULL) \
+    PHP_FE(git2_commit_info,NULL)                                       \
+    PHP_FE(git2_commit_info_many,NULL)
 
 #endif
 
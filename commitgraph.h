@@ -0,0 +1,401 @@
+/*
+ * commitgraph.h
+ *
+ * Copyright (C) Roger P. Gee
+ */
+
+#ifndef PHPGIT2_COMMITGRAPH_H
+#define PHPGIT2_COMMITGRAPH_H
+
+namespace php_git2
+{
+    // Explicitly specialize git2_resource destructors for the commit-graph
+    // types.
+
+    template<> php_git_commit_graph::~git2_resource()
+    {
+        git_commit_graph_free(handle);
+    }
+
+    template<> php_git_commit_graph_writer::~git2_resource()
+    {
+        git_commit_graph_writer_free(handle);
+    }
+
+    class php_git_commit_graph_writer_options:
+        public php_option_array
+    {
+    public:
+        php_git_commit_graph_writer_options()
+        {
+            git_commit_graph_writer_options_init(&opts,GIT_COMMIT_GRAPH_WRITER_OPTIONS_VERSION);
+        }
+
+        git_commit_graph_writer_options* byval_git2()
+        {
+            if (!is_null()) {
+                array_wrapper arr(value);
+
+                GIT2_ARRAY_LOOKUP_LONG(arr,version,opts);
+                GIT2_ARRAY_LOOKUP_LONG(arr,split_strategy,opts);
+                GIT2_ARRAY_LOOKUP_LONG(arr,max_commits,opts);
+
+                if (arr.query("size_multiple",sizeof("size_multiple")-1)) {
+                    opts.size_multiple = static_cast<float>(zval_get_double(arr.get_value()));
+                }
+            }
+
+            return &opts;
+        }
+
+    private:
+        git_commit_graph_writer_options opts;
+    };
+
+    // Returns the modification time of a file or zero if it does not exist.
+
+    inline int64_t php_git2_commit_graph_mtime(const std::string& path)
+    {
+        zend_stat_t st;
+
+        if (VCWD_STAT(path.c_str(),&st) != 0) {
+            return 0;
+        }
+
+        return php_git2_stat_mtime(st);
+    }
+
+    // Returns the newest modification time of the files in a directory. If
+    // 'packs' is true, only pack files and pack indexes are considered;
+    // otherwise subdirectories are scanned recursively (for loose refs). Lock
+    // files are ignored since they come and go with every ref update.
+
+    inline int64_t php_git2_commit_graph_newest(const std::string& dirPath,bool packs)
+    {
+        int64_t newest = 0;
+        DIR* dir;
+        struct dirent* ent;
+
+        dir = VCWD_OPENDIR(dirPath.c_str());
+        if (dir == nullptr) {
+            return 0;
+        }
+
+        while ((ent = readdir(dir)) != nullptr) {
+            size_t len = strlen(ent->d_name);
+            zend_stat_t st;
+            int64_t mtime;
+
+            // NOTE: Ref names cannot begin with '.', so this also skips the
+            // '.' and '..' entries.
+            if (ent->d_name[0] == '.'
+                || (len > 5 && strcmp(ent->d_name + len - 5,".lock") == 0))
+            {
+                continue;
+            }
+
+            if (packs
+                && (len <= 5 || strcmp(ent->d_name + len - 5,".pack") != 0)
+                && (len <= 4 || strcmp(ent->d_name + len - 4,".idx") != 0))
+            {
+                continue;
+            }
+
+            std::string path = dirPath + "/" + ent->d_name;
+            if (VCWD_STAT(path.c_str(),&st) != 0) {
+                continue;
+            }
+
+            if (S_ISDIR(st.st_mode)) {
+                if (packs) {
+                    continue;
+                }
+
+                mtime = php_git2_commit_graph_newest(path,false);
+            }
+            else {
+                mtime = php_git2_stat_mtime(st);
+            }
+
+            if (mtime > newest) {
+                newest = mtime;
+            }
+        }
+
+        closedir(dir);
+
+        return newest;
+    }
+
+    // Implements git2_commit_graph_update(). The commit-graph is rewritten from
+    // all commits reachable from refs if it is missing or not newer than the
+    // newest pack or pack index, packed-refs or any loose ref (which change on
+    // every fetch or push). Returns true if the commit-graph was written.
+    //
+    // NOTE: The commit-graph is always written as a single file from scratch;
+    // libgit2 does not support incremental (split) commit-graph chains. Walking
+    // the refs is cheap compared to the fetch or push that made the graph
+    // stale.
+
+    inline bool php_git2_commit_graph_update(git_repository* repo,bool force)
+    {
+        // NOTE: git_repository_commondir() always includes a trailing path
+        // separator.
+
+        std::string base = git_repository_commondir(repo);
+        std::string infoDir = base + "objects/info";
+
+        if (!force) {
+            int64_t graph = php_git2_commit_graph_mtime(infoDir + "/commit-graph");
+
+            // The comparisons are strict so that an update within the same
+            // timestamp tick as the last write is not missed.
+
+            if (graph != 0
+                && php_git2_commit_graph_newest(base + "objects/pack",true) < graph
+                && php_git2_commit_graph_mtime(base + "packed-refs") < graph
+                && php_git2_commit_graph_newest(base + "refs",false) < graph)
+            {
+                return false;
+            }
+        }
+
+        int retval;
+        git_commit_graph_writer* writer;
+        git_commit_graph_writer_options opts;
+        git_revwalk* walk;
+
+        retval = git_revwalk_new(&walk,repo);
+        if (retval < 0) {
+            git_error(retval);
+        }
+
+        retval = git_revwalk_push_glob(walk,"refs/*");
+        if (retval == 0) {
+            // HEAD may be detached; an unborn HEAD is not an error.
+            if (git_revwalk_push_head(walk) < 0) {
+                giterr_clear();
+            }
+
+            retval = git_commit_graph_writer_new(&writer,infoDir.c_str());
+        }
+        if (retval < 0) {
+            git_revwalk_free(walk);
+            git_error(retval);
+        }
+
+        git_commit_graph_writer_options_init(&opts,GIT_COMMIT_GRAPH_WRITER_OPTIONS_VERSION);
+
+        retval = git_commit_graph_writer_add_revwalk(writer,walk);
+        if (retval == 0) {
+            retval = git_commit_graph_writer_commit(writer,&opts);
+        }
+
+        git_commit_graph_writer_free(writer);
+        git_revwalk_free(walk);
+
+        if (retval < 0) {
+            git_error(retval);
+        }
+
+        return true;
+    }
+
+} // namespace php_git2
+
+// Functions:
+
+static constexpr auto ZIF_GIT_COMMIT_GRAPH_OPEN = zif_php_git2_function<
+    php_git2::func_wrapper<
+        int,
+        git_commit_graph**,
+        const char*>::func<git_commit_graph_open>,
+    php_git2::local_pack<
+        php_git2::php_resource_ref<php_git2::php_git_commit_graph>,
+        php_git2::php_string
+        >,
+    1,
+    php_git2::sequence<1>,
+    php_git2::sequence<0,1>
+    >;
+
+static constexpr auto ZIF_GIT_COMMIT_GRAPH_FREE = zif_php_git2_function_free<
+    php_git2::local_pack<
+        php_git2::php_resource_cleanup<php_git2::php_git_commit_graph>
+        >
+    >;
+
+static constexpr auto ZIF_GIT_COMMIT_GRAPH_WRITER_NEW = zif_php_git2_function<
+    php_git2::func_wrapper<
+        int,
+        git_commit_graph_writer**,
+        const char*>::func<git_commit_graph_writer_new>,
+    php_git2::local_pack<
+        php_git2::php_resource_ref<php_git2::php_git_commit_graph_writer>,
+        php_git2::php_string
+        >,
+    1,
+    php_git2::sequence<1>,
+    php_git2::sequence<0,1>
+    >;
+
+static constexpr auto ZIF_GIT_COMMIT_GRAPH_WRITER_FREE = zif_php_git2_function_free<
+    php_git2::local_pack<
+        php_git2::php_resource_cleanup<php_git2::php_git_commit_graph_writer>
+        >
+    >;
+
+static constexpr auto ZIF_GIT_COMMIT_GRAPH_WRITER_ADD_INDEX_FILE = zif_php_git2_function<
+    php_git2::func_wrapper<
+        int,
+        git_commit_graph_writer*,
+        git_repository*,
+        const char*>::func<git_commit_graph_writer_add_index_file>,
+    php_git2::local_pack<
+        php_git2::php_resource<php_git2::php_git_commit_graph_writer>,
+        php_git2::php_resource<php_git2::php_git_repository>,
+        php_git2::php_string
+        >
+    >;
+
+static constexpr auto ZIF_GIT_COMMIT_GRAPH_WRITER_ADD_REVWALK = zif_php_git2_function<
+    php_git2::func_wrapper<
+        int,
+        git_commit_graph_writer*,
+        git_revwalk*>::func<git_commit_graph_writer_add_revwalk>,
+    php_git2::local_pack<
+        php_git2::php_resource<php_git2::php_git_commit_graph_writer>,
+        php_git2::php_resource<php_git2::php_git_revwalk>
+        >
+    >;
+
+static constexpr auto ZIF_GIT_COMMIT_GRAPH_WRITER_COMMIT = zif_php_git2_function<
+    php_git2::func_wrapper<
+        int,
+        git_commit_graph_writer*,
+        git_commit_graph_writer_options*>::func<git_commit_graph_writer_commit>,
+    php_git2::local_pack<
+        php_git2::php_resource<php_git2::php_git_commit_graph_writer>,
+        php_git2::php_git_commit_graph_writer_options
+        >
+    >;
+
+static constexpr auto ZIF_GIT_COMMIT_GRAPH_WRITER_DUMP = zif_php_git2_function<
+    php_git2::func_wrapper<
+        int,
+        git_buf*,
+        git_commit_graph_writer*,
+        git_commit_graph_writer_options*>::func<git_commit_graph_writer_dump>,
+    php_git2::local_pack<
+        php_git2::php_git_buf,
+        php_git2::php_resource<php_git2::php_git_commit_graph_writer>,
+        php_git2::php_git_commit_graph_writer_options
+        >,
+    1,
+    php_git2::sequence<1,2>,
+    php_git2::sequence<0,1,2>
+    >;
+
+static PHP_FUNCTION(git_odb_set_commit_graph)
+{
+    php_git2::php_bailer bailer;
+
+    {
+        php_git2::php_resource<php_git2::php_git_odb> odb;
+        php_git2::php_resource<php_git2::php_git_commit_graph> cgraph;
+        php_git2::php_bailout_context ctx(bailer);
+
+        if (BAILOUT_ENTER_REGION(ctx)) {
+            zval* zodb;
+            zval* zcgraph;
+            if (zend_parse_parameters(ZEND_NUM_ARGS(),"zz",&zodb,&zcgraph) == FAILURE) {
+                return;
+            }
+
+            try {
+                int retval;
+
+                odb.parse(zodb,1);
+                cgraph.parse(zcgraph,2);
+
+                // The ODB takes ownership of the commit-graph, so the resource
+                // must currently own the handle.
+                if (!cgraph.get_object()->is_owner()) {
+                    throw php_git2::php_git2_error_exception(
+                        "The commit-graph resource is already owned by an ODB");
+                }
+
+                retval = git_odb_set_commit_graph(odb.byval_git2(),cgraph.byval_git2());
+                if (retval < 0) {
+                    php_git2::git_error(retval);
+                }
+
+                // The handle is now freed with the ODB. Make the resource depend
+                // on the ODB so the handle remains valid while it is in use.
+                cgraph.get_object()->revoke_ownership();
+                cgraph.get_object()->set_parent(odb.get_object());
+
+            } catch (php_git2::php_git2_exception_base& ex) {
+                php_git2::php_bailout_context ctx2(bailer);
+
+                if (BAILOUT_ENTER_REGION(ctx2)) {
+                    ex.handle();
+                }
+            }
+        }
+    }
+}
+
+static PHP_FUNCTION(git2_commit_graph_update)
+{
+    php_git2::php_bailer bailer;
+
+    {
+        php_git2::php_resource<php_git2::php_git_repository> repo;
+        php_git2::php_bailout_context ctx(bailer);
+
+        if (BAILOUT_ENTER_REGION(ctx)) {
+            zval* zrepo;
+            zend_bool force = 0;
+            if (zend_parse_parameters(ZEND_NUM_ARGS(),"z|b",&zrepo,&force) == FAILURE) {
+                return;
+            }
+
+            try {
+                repo.parse(zrepo,1);
+                RETVAL_BOOL(php_git2::php_git2_commit_graph_update(repo.byval_git2(),force));
+
+            } catch (php_git2::php_git2_exception_base& ex) {
+                php_git2::php_bailout_context ctx2(bailer);
+
+                if (BAILOUT_ENTER_REGION(ctx2)) {
+                    ex.handle();
+                }
+            }
+        }
+    }
+}
+
+// Function Entries:
+
+#define GIT_COMMITGRAPH_FE                                              \
+    PHP_GIT2_FE(git_commit_graph_open,ZIF_GIT_COMMIT_GRAPH_OPEN,NULL)   \
+    PHP_GIT2_FE(git_commit_graph_free,ZIF_GIT_COMMIT_GRAPH_FREE,NULL)   \
+    PHP_GIT2_FE(git_commit_graph_writer_new,ZIF_GIT_COMMIT_GRAPH_WRITER_NEW,NULL) \
+    PHP_GIT2_FE(git_commit_graph_writer_free,ZIF_GIT_COMMIT_GRAPH_WRITER_FREE,NULL) \
+    PHP_GIT2_FE(git_commit_graph_writer_add_index_file,ZIF_GIT_COMMIT_GRAPH_WRITER_ADD_INDEX_FILE,NULL) \
+    PHP_GIT2_FE(git_commit_graph_writer_add_revwalk,ZIF_GIT_COMMIT_GRAPH_WRITER_ADD_REVWALK,NULL) \
+    PHP_GIT2_FE(git_commit_graph_writer_commit,ZIF_GIT_COMMIT_GRAPH_WRITER_COMMIT,NULL) \
+    PHP_GIT2_FE(git_commit_graph_writer_dump,ZIF_GIT_COMMIT_GRAPH_WRITER_DUMP,NULL) \
+    PHP_FE(git_odb_set_commit_graph,NULL)                               \
+    PHP_FE(git2_commit_graph_update,NULL)
+
+#endif
+
+/*
+ * Local Variables:
+ * mode:c++
+ * indent-tabs-mode:nil
+ * tab-width:4
+ * End:
+ */
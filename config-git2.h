@@ -769,6 +769,65 @@ static constexpr auto ZIF_GIT_CONFIG_LOOKUP_MAP_VALUE = zif_php_git2_function<
     php_git2::sequence<0,2,1,3>
     >;
 
+static PHP_FUNCTION(git2_config_backend_set_cache)
+{
+    php_git2::php_bailer bailer;
+
+    {
+        php_git2::php_object<php_git2::php_config_backend_object> backend;
+        php_git2::php_bailout_context ctx(bailer);
+
+        if (BAILOUT_ENTER_REGION(ctx)) {
+            zval* zbackend;
+            zend_bool enable;
+            if (zend_parse_parameters(ZEND_NUM_ARGS(),"zb",&zbackend,&enable) == FAILURE) {
+                return;
+            }
+
+            try {
+                backend.parse(zbackend,1);
+                backend.get_storage()->cache.set_enabled(enable);
+
+            } catch (php_git2::php_git2_exception_base& ex) {
+                php_git2::php_bailout_context ctx2(bailer);
+
+                if (BAILOUT_ENTER_REGION(ctx2)) {
+                    ex.handle();
+                }
+            }
+        }
+    }
+}
+
+static PHP_FUNCTION(git2_config_backend_cache_stats)
+{
+    php_git2::php_bailer bailer;
+
+    {
+        php_git2::php_object<php_git2::php_config_backend_object> backend;
+        php_git2::php_bailout_context ctx(bailer);
+
+        if (BAILOUT_ENTER_REGION(ctx)) {
+            zval* zbackend;
+            if (zend_parse_parameters(ZEND_NUM_ARGS(),"z",&zbackend) == FAILURE) {
+                return;
+            }
+
+            try {
+                backend.parse(zbackend,1);
+                backend.get_storage()->cache.get_stats(return_value);
+
+            } catch (php_git2::php_git2_exception_base& ex) {
+                php_git2::php_bailout_context ctx2(bailer);
+
+                if (BAILOUT_ENTER_REGION(ctx2)) {
+                    ex.handle();
+                }
+            }
+        }
+    }
+}
+
 // Function Entries:
 
 #define GIT_CONFIG_FE                                                   \
@@ -813,7 +872,9 @@ static constexpr auto ZIF_GIT_CONFIG_LOOKUP_MAP_VALUE = zif_php_git2_function<
     PHP_GIT2_FE(git_config_multivar_iterator_new,ZIF_GIT_CONFIG_MULTIVAR_ITERATOR_NEW,NULL) \
     PHP_GIT2_FE(git_config_iterator_glob_new,ZIF_GIT_CONFIG_ITERATOR_GLOB_NEW,NULL) \
     PHP_GIT2_FE(git_config_next,ZIF_GIT_CONFIG_NEXT,NULL)               \
-    PHP_GIT2_FE(git_config_lookup_map_value,ZIF_GIT_CONFIG_LOOKUP_MAP_VALUE,NULL)
+    PHP_GIT2_FE(git_config_lookup_map_value,ZIF_GIT_CONFIG_LOOKUP_MAP_VALUE,NULL) \
+    PHP_FE(git2_config_backend_set_cache,NULL)                          \
+    PHP_FE(git2_config_backend_cache_stats,NULL)
 
 #endif
 
@@ -9,6 +9,10 @@ PHP_ARG_WITH(git2, Whether to include "git2" support,
 PHP_ARG_WITH(git2-static, Whether to include "git2" support (static libraries),
     [  --with-git2-static      Force using static libgit2], no, no)
 
+PHP_ARG_WITH(git2-sqlite, Whether to include the native SQLite ODB backend,
+    [  --with-git2-sqlite[=DIR]  Include the native SQLite ODB backend; DIR is the
+                          install prefix for the sqlite3 library], no, no)
+
 # Here we add the libgit2 library to the build.
 if test "$PHP_GIT2" != "no"; then
     # Compile list of directories to search for libgit2.
@@ -55,6 +59,38 @@ if test "$PHP_GIT2" != "no"; then
     fi
 fi
 
+# Optionally add the sqlite3 library for the native SQLite ODB backend.
+if test "$PHP_GIT2" != "no" && test "$PHP_GIT2_SQLITE" != "no"; then
+    GIT2_SQLITE_SEARCH_DIRS="/usr/local /usr"
+    if test "$PHP_GIT2_SQLITE" != "yes"; then
+        GIT2_SQLITE_SEARCH_DIRS="$PHP_GIT2_SQLITE $GIT2_SQLITE_SEARCH_DIRS"
+    fi
+
+    AC_MSG_CHECKING([for sqlite3.h header])
+    for i in $GIT2_SQLITE_SEARCH_DIRS; do
+      test -f $i/include/sqlite3.h && GIT2_SQLITE_DIR=$i && break
+    done
+
+    if test -z "$GIT2_SQLITE_DIR"; then
+        AC_MSG_RESULT([not found])
+        AC_MSG_ERROR([sqlite3.h not found; install sqlite3 or omit --with-git2-sqlite])
+    fi
+    AC_MSG_RESULT([yes])
+
+    PHP_CHECK_LIBRARY(sqlite3,sqlite3_bind_blob64,
+    [
+        PHP_ADD_INCLUDE($GIT2_SQLITE_DIR/include)
+        PHP_ADD_LIBRARY_WITH_PATH(sqlite3, $GIT2_SQLITE_DIR/lib, GIT2_SHARED_LIBADD)
+        AC_DEFINE(HAVE_GIT2_SQLITE, 1, [Whether the native SQLite ODB backend is built])
+    ],
+    [
+        AC_MSG_ERROR([sqlite3 library (3.8.7 or later) not found])
+    ],
+    [
+      -L$GIT2_SQLITE_DIR/lib
+    ])
+fi
+
 if test $PHP_GIT2 != "no"; then
     PHP_REQUIRE_CXX()
     PHP_ADD_LIBRARY(stdc++, 1, GIT2_SHARED_LIBADD)
@@ -81,6 +117,7 @@ if test $PHP_GIT2 != "no"; then
         php-object.cpp \
         php-odb-backend.cpp \
         php-odb-backend-internal.cpp \
+        php-odb-backend-sqlite.cpp \
         php-odb-writepack.cpp \
         php-odb-writepack-internal.cpp \
         php-odb-stream.cpp \
@@ -90,7 +127,11 @@ if test $PHP_GIT2 != "no"; then
         php-array.cpp \
         php-closure.cpp \
         php-refdb-backend.cpp \
-        php-refdb-backend-internal.cpp,$ext_shared)
+        php-refdb-backend-internal.cpp \
+        php-persistent.cpp \
+        php-opts.cpp \
+        php-stream.cpp \
+        php-resource.cpp,$ext_shared)
 fi
 
 #
@@ -362,6 +362,121 @@ namespace php_git2
         git_signature* sig;
     };
 
+    // Builds the full delta, hunk and line structure of a diff. This is the
+    // implementation of git2_diff_materialize().
+
+    inline void php_git2_diff_materialize(zval* return_value,git_diff* diff,zend_long flags)
+    {
+        size_t ndeltas = git_diff_num_deltas(diff);
+        bool offsets = (flags & GIT2_DIFF_MATERIALIZE_OFFSETS) != 0;
+
+        array_init_size(return_value,ndeltas);
+
+        for (size_t i = 0;i < ndeltas;++i) {
+            int retval;
+            git_patch* patch;
+            const git_diff_delta* delta;
+            zval zfile;
+            zval zdelta;
+            zval zhunks;
+            smart_str content = {0};
+
+            retval = git_patch_from_diff(&patch,diff,i);
+            if (retval < 0) {
+                git_error(retval);
+            }
+
+            delta = git_diff_get_delta(diff,i);
+            convert_diff_delta(&zdelta,delta);
+
+            array_init_size(&zfile,4);
+            add_assoc_zval_ex(&zfile,"delta",sizeof("delta")-1,&zdelta);
+            add_assoc_bool_ex(&zfile,
+                "binary",
+                sizeof("binary")-1,
+                (delta->flags & GIT_DIFF_FLAG_BINARY) != 0);
+
+            // NOTE: libgit2 does not produce a patch for binary or unchanged
+            // files.
+
+            size_t nhunks = (patch != nullptr) ? git_patch_num_hunks(patch) : 0;
+            array_init_size(&zhunks,nhunks);
+
+            for (size_t j = 0;j < nhunks;++j) {
+                const git_diff_hunk* hunk;
+                size_t nlines;
+                zval zhunk;
+                zval zlines;
+
+                retval = git_patch_get_hunk(&hunk,&nlines,patch,j);
+                if (retval < 0) {
+                    smart_str_free(&content);
+                    git_patch_free(patch);
+                    zval_ptr_dtor(&zhunks);
+                    zval_ptr_dtor(&zfile);
+                    git_error(retval);
+                }
+
+                convert_diff_hunk(&zhunk,hunk);
+                array_init_size(&zlines,nlines);
+
+                for (size_t k = 0;k < nlines;++k) {
+                    const git_diff_line* line;
+                    zval zline;
+
+                    retval = git_patch_get_line_in_hunk(&line,patch,j,k);
+                    if (retval < 0) {
+                        smart_str_free(&content);
+                        git_patch_free(patch);
+                        zval_ptr_dtor(&zlines);
+                        zval_ptr_dtor(&zhunk);
+                        zval_ptr_dtor(&zhunks);
+                        zval_ptr_dtor(&zfile);
+                        git_error(retval);
+                    }
+
+                    if (offsets) {
+                        // Represent the line as a packed list referencing the
+                        // shared content string: [origin, old_lineno,
+                        // new_lineno, offset, length].
+
+                        array_init_size(&zline,5);
+                        add_next_index_long(&zline,line->origin);
+                        add_next_index_long(&zline,line->old_lineno);
+                        add_next_index_long(&zline,line->new_lineno);
+                        add_next_index_long(&zline,content.s != nullptr ? ZSTR_LEN(content.s) : 0);
+                        add_next_index_long(&zline,line->content_len);
+
+                        smart_str_appendl(&content,line->content,line->content_len);
+                    }
+                    else {
+                        convert_diff_line(&zline,line);
+                    }
+
+                    add_next_index_zval(&zlines,&zline);
+                }
+
+                add_assoc_zval_ex(&zhunk,"lines",sizeof("lines")-1,&zlines);
+                add_next_index_zval(&zhunks,&zhunk);
+            }
+
+            add_assoc_zval_ex(&zfile,"hunks",sizeof("hunks")-1,&zhunks);
+
+            if (offsets) {
+                smart_str_0(&content);
+                if (content.s != nullptr) {
+                    add_assoc_str_ex(&zfile,"content",sizeof("content")-1,content.s);
+                }
+                else {
+                    add_assoc_stringl_ex(&zfile,"content",sizeof("content")-1,"",0);
+                }
+            }
+
+            git_patch_free(patch);
+            add_next_index_zval(return_value,&zfile);
+        }
+    }
+
 } // namespace php_git2
 
 // Functions:
@@ -871,6 +986,36 @@ static constexpr auto ZIF_GIT_DIFF_INDEX_TO_WORKDIR = zif_php_git2_function_setd
     php_git2::sequence<0,1,2,3>
     >;
 
+static PHP_FUNCTION(git2_diff_materialize)
+{
+    php_git2::php_bailer bailer;
+
+    {
+        php_git2::php_resource<php_git2::php_git_diff> diff;
+        php_git2::php_bailout_context ctx(bailer);
+
+        if (BAILOUT_ENTER_REGION(ctx)) {
+            zval* zvp;
+            zend_long flags = 0;
+            if (zend_parse_parameters(ZEND_NUM_ARGS(),"z|l",&zvp,&flags) == FAILURE) {
+                return;
+            }
+
+            try {
+                diff.parse(zvp,1);
+                php_git2::php_git2_diff_materialize(return_value,diff.byval_git2(),flags);
+
+            } catch (php_git2::php_git2_exception_base& ex) {
+                php_git2::php_bailout_context ctx2(bailer);
+
+                if (BAILOUT_ENTER_REGION(ctx2)) {
+                    ex.handle();
+                }
+            }
+        }
+    }
+}
+
 // Function Entries:
 
 #define GIT_DIFF_FE                                                     \
@@ -903,7 +1048,8 @@ static constexpr auto ZIF_GIT_DIFF_INDEX_TO_WORKDIR = zif_php_git2_function_setd
     PHP_GIT2_FE(git_diff_format_email,ZIF_GIT_DIFF_FORMAT_EMAIL,NULL)   \
     PHP_GIT2_FE(git_diff_index_to_index,ZIF_GIT_DIFF_INDEX_TO_INDEX,NULL) \
     PHP_GIT2_FE(git_diff_tree_to_index,ZIF_GIT_DIFF_TREE_TO_INDEX,NULL) \
-    PHP_GIT2_FE(git_diff_index_to_workdir,ZIF_GIT_DIFF_INDEX_TO_WORKDIR,NULL)
+    PHP_GIT2_FE(git_diff_index_to_workdir,ZIF_GIT_DIFF_INDEX_TO_WORKDIR,NULL) \
+    PHP_FE(git2_diff_materialize,NULL)
 
 #endif
 
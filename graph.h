@@ -0,0 +1,402 @@
+/*
+ * graph.h
+ *
+ * Copyright (C) Roger P. Gee
+ */
+
+#ifndef PHPGIT2_GRAPH_H
+#define PHPGIT2_GRAPH_H
+#include <git2/graph.h>
+#include <vector>
+#include <queue>
+#include <unordered_map>
+
+namespace php_git2
+{
+
+    // Computes ahead/behind counts for many tips against a single base using
+    // one history walk. Each visited commit carries a bitset recording which
+    // of the base (bit 0) and tips (bits 1..N) can reach it. Like libgit2's
+    // own ahead/behind walk, commits are visited newest first and the walk
+    // stops once every queued commit is reachable from all starting points.
+    //
+    // Commit times only order the walk. Once a visited commit turns out to be
+    // no newer than one of its parents (clock skew or equal times), a commit
+    // may have been visited before all of its bits arrived, so the walk then
+    // keeps going until no commit gains new bits. As with libgit2, skew among
+    // commits below the point where the walk stops is not detected.
+
+    class php_git2_graph_walker
+    {
+    public:
+        php_git2_graph_walker(git_repository* repository,size_t ntips):
+            repo(repository), words((ntips + 1 + 63) / 64), nstale(0), skewed(false)
+        {
+            full.assign(words,0);
+            for (size_t i = 0;i < ntips + 1;++i) {
+                full[i / 64] |= uint64_t(1) << (i % 64);
+            }
+        }
+
+        void mark(const git_oid* oid,size_t bit)
+        {
+            size_t index = add_node(oid);
+            uint64_t* nodeBits = get_bits(index);
+
+            nodeBits[bit / 64] |= uint64_t(1) << (bit % 64);
+            enqueue(index);
+        }
+
+        void walk()
+        {
+            while (!queue.empty() && (skewed || nstale < queue.size())) {
+                size_t index = queue.top().second;
+                queue.pop();
+
+                nodes[index].queued = false;
+                if (is_stale(index)) {
+                    nstale -= 1;
+                }
+
+                // NOTE: Adding nodes may reallocate the node and bit storage, so
+                // we index into them on each iteration.
+
+                for (size_t p = 0;p < nodes[index].parents.size();++p) {
+                    git_oid parentId = nodes[index].parents[p];
+                    size_t parent = add_node(&parentId);
+                    uint64_t* src = get_bits(index);
+                    uint64_t* dst = get_bits(parent);
+                    bool changed = false;
+
+                    if (nodes[parent].time >= nodes[index].time) {
+                        skewed = true;
+                    }
+
+                    for (size_t w = 0;w < words;++w) {
+                        uint64_t merged = dst[w] | src[w];
+                        if (merged != dst[w]) {
+                            dst[w] = merged;
+                            changed = true;
+                        }
+                    }
+
+                    // A parent is (re)queued whenever it gains new bits so that
+                    // bits that arrive late (see above) still reach every
+                    // ancestor.
+                    if (changed) {
+                        if (nodes[parent].queued) {
+                            if (is_stale(parent)) {
+                                nstale += 1;
+                            }
+                        }
+                        else {
+                            enqueue(parent);
+                        }
+                    }
+                }
+            }
+        }
+
+        void get_counts(size_t tip,size_t* ahead,size_t* behind)
+        {
+            size_t bit = tip + 1;
+            size_t word = bit / 64;
+            uint64_t mask = uint64_t(1) << (bit % 64);
+
+            *ahead = 0;
+            *behind = 0;
+            for (size_t i = 0;i < nodes.size();++i) {
+                const uint64_t* nodeBits = get_bits(i);
+                bool fromBase = (nodeBits[0] & 1) != 0;
+                bool fromTip = (nodeBits[word] & mask) != 0;
+
+                if (fromTip && !fromBase) {
+                    *ahead += 1;
+                }
+                else if (fromBase && !fromTip) {
+                    *behind += 1;
+                }
+            }
+        }
+
+    private:
+        struct node
+        {
+            git_time_t time;
+            std::vector<git_oid> parents;
+            bool queued;
+        };
+
+        struct oid_hash
+        {
+            size_t operator()(const git_oid& oid) const
+            {
+                size_t value;
+                memcpy(&value,oid.id,sizeof(value));
+                return value;
+            }
+        };
+
+        struct oid_equal
+        {
+            bool operator()(const git_oid& a,const git_oid& b) const
+            {
+                return git_oid_equal(&a,&b);
+            }
+        };
+
+        using queue_entry = std::pair<git_time_t,size_t>;
+
+        size_t add_node(const git_oid* oid)
+        {
+            auto iter = lookup.find(*oid);
+            if (iter != lookup.end()) {
+                return iter->second;
+            }
+
+            int retval;
+            git_commit* commit;
+            node n;
+
+            retval = git_commit_lookup(&commit,repo,oid);
+            if (retval < 0) {
+                git_error(retval);
+            }
+
+            n.time = git_commit_time(commit);
+            n.queued = false;
+            n.parents.reserve(git_commit_parentcount(commit));
+            for (unsigned int i = 0;i < git_commit_parentcount(commit);++i) {
+                n.parents.push_back(*git_commit_parent_id(commit,i));
+            }
+
+            git_commit_free(commit);
+
+            size_t index = nodes.size();
+            nodes.push_back(std::move(n));
+            bits.resize(bits.size() + words,0);
+            lookup.emplace(*oid,index);
+
+            return index;
+        }
+
+        uint64_t* get_bits(size_t index)
+        {
+            return bits.data() + index * words;
+        }
+
+        bool is_stale(size_t index)
+        {
+            const uint64_t* nodeBits = get_bits(index);
+
+            for (size_t w = 0;w < words;++w) {
+                if (nodeBits[w] != full[w]) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        void enqueue(size_t index)
+        {
+            node& n = nodes[index];
+
+            if (!n.queued) {
+                n.queued = true;
+                queue.emplace(n.time,index);
+                if (is_stale(index)) {
+                    nstale += 1;
+                }
+            }
+        }
+
+        git_repository* repo;
+        size_t words;
+        size_t nstale;
+        bool skewed;
+        std::vector<uint64_t> full;
+        std::vector<node> nodes;
+        std::vector<uint64_t> bits;
+        std::unordered_map<git_oid,size_t,oid_hash,oid_equal> lookup;
+        std::priority_queue<queue_entry> queue;
+    };
+
+    // Implements git2_graph_ahead_behind_many(). The result preserves the keys
+    // of the tips array.
+
+    inline void php_git2_graph_ahead_behind_many(zval* return_value,
+        git_repository* repo,
+        const git_oid* base,
+        zval* ztips)
+    {
+        HashTable* tips = Z_ARRVAL_P(ztips);
+        php_git2_graph_walker walker(repo,zend_hash_num_elements(tips));
+        zend_ulong index;
+        zend_string* key;
+        zval* zoid;
+        size_t n;
+
+        walker.mark(base,0);
+
+        n = 0;
+        ZEND_HASH_FOREACH_VAL(tips,zoid) {
+            git_oid oid;
+
+            ZVAL_DEREF(zoid);
+
+            if (Z_TYPE_P(zoid) != IS_STRING
+                || convert_oid_fromstr(&oid,Z_STRVAL_P(zoid),Z_STRLEN_P(zoid)) < 0)
+            {
+                throw php_git2_error_exception("Array element is not a valid OID");
+            }
+
+            walker.mark(&oid,++n);
+        } ZEND_HASH_FOREACH_END();
+
+        walker.walk();
+
+        array_init_size(return_value,zend_hash_num_elements(tips));
+
+        n = 0;
+        ZEND_HASH_FOREACH_KEY(tips,index,key) {
+            size_t ahead, behind;
+            zval zpair;
+
+            walker.get_counts(n++,&ahead,&behind);
+
+            array_init_size(&zpair,2);
+            add_next_index_long(&zpair,static_cast<zend_long>(ahead));
+            add_next_index_long(&zpair,static_cast<zend_long>(behind));
+
+            if (key != nullptr) {
+                zend_hash_update(Z_ARRVAL_P(return_value),key,&zpair);
+            }
+            else {
+                zend_hash_index_update(Z_ARRVAL_P(return_value),index,&zpair);
+            }
+        } ZEND_HASH_FOREACH_END();
+    }
+
+} // namespace php_git2
+
+// Functions:
+
+static constexpr auto ZIF_GIT_GRAPH_AHEAD_BEHIND = zif_php_git2_function<
+    php_git2::func_wrapper<
+        int,
+        size_t*,
+        size_t*,
+        git_repository*,
+        const git_oid*,
+        const git_oid*>::func<git_graph_ahead_behind>,
+    php_git2::local_pack<
+        php_git2::php_long_ref<size_t>,
+        php_git2::php_long_out<size_t>,
+        php_git2::php_resource<php_git2::php_git_repository>,
+        php_git2::php_git_oid_fromstr,
+        php_git2::php_git_oid_fromstr
+        >,
+    1,
+    php_git2::sequence<1,2,3,4>,
+    php_git2::sequence<0,1,2,3,4>
+    >;
+ZEND_BEGIN_ARG_INFO_EX(git_graph_ahead_behind_arginfo,0,0,4)
+    ZEND_ARG_PASS_INFO(1)
+ZEND_END_ARG_INFO()
+
+static constexpr auto ZIF_GIT_GRAPH_DESCENDANT_OF = zif_php_git2_function_rethandler<
+    php_git2::func_wrapper<
+        int,
+        git_repository*,
+        const git_oid*,
+        const git_oid*>::func<git_graph_descendant_of>,
+    php_git2::local_pack<
+        php_git2::php_resource<php_git2::php_git_repository>,
+        php_git2::php_git_oid_fromstr,
+        php_git2::php_git_oid_fromstr
+        >,
+    php_git2::php_boolean_error_rethandler<int>
+    >;
+
+static constexpr auto ZIF_GIT_GRAPH_REACHABLE_FROM_ANY = zif_php_git2_function_rethandler<
+    php_git2::func_wrapper<
+        int,
+        git_repository*,
+        const git_oid*,
+        const git_oid[],
+        size_t>::func<git_graph_reachable_from_any>,
+    php_git2::local_pack<
+        php_git2::php_resource<php_git2::php_git_repository>,
+        php_git2::php_git_oid_fromstr,
+        php_git2::connector_wrapper<
+            php_git2::php_array_length_connector<
+                size_t,
+                php_git2::php_git_oid_byval_array
+                >
+            >,
+        php_git2::php_git_oid_byval_array
+        >,
+    php_git2::php_boolean_error_rethandler<int>,
+    php_git2::sequence<0,1,3>,
+    php_git2::sequence<0,1,3,2>
+    >;
+
+static PHP_FUNCTION(git2_graph_ahead_behind_many)
+{
+    php_git2::php_bailer bailer;
+
+    {
+        php_git2::php_resource<php_git2::php_git_repository> repo;
+        php_git2::php_bailout_context ctx(bailer);
+
+        if (BAILOUT_ENTER_REGION(ctx)) {
+            zval* zrepo;
+            char* base;
+            size_t baseLength;
+            zval* ztips;
+            if (zend_parse_parameters(ZEND_NUM_ARGS(),"zsa",&zrepo,&base,&baseLength,&ztips) == FAILURE) {
+                return;
+            }
+
+            try {
+                git_oid baseId;
+
+                repo.parse(zrepo,1);
+                if (php_git2::convert_oid_fromstr(&baseId,base,baseLength) < 0) {
+                    throw php_git2::php_git2_error_exception("Base is not a valid OID");
+                }
+
+                php_git2::php_git2_graph_ahead_behind_many(return_value,
+                    repo.byval_git2(),
+                    &baseId,
+                    ztips);
+
+            } catch (php_git2::php_git2_exception_base& ex) {
+                php_git2::php_bailout_context ctx2(bailer);
+
+                if (BAILOUT_ENTER_REGION(ctx2)) {
+                    ex.handle();
+                }
+            }
+        }
+    }
+}
+
+// Function Entries:
+
+#define GIT_GRAPH_FE                                                    \
+    PHP_GIT2_FE(git_graph_ahead_behind,ZIF_GIT_GRAPH_AHEAD_BEHIND,git_graph_ahead_behind_arginfo) \
+    PHP_GIT2_FE(git_graph_descendant_of,ZIF_GIT_GRAPH_DESCENDANT_OF,NULL) \
+    PHP_GIT2_FE(git_graph_reachable_from_any,ZIF_GIT_GRAPH_REACHABLE_FROM_ANY,NULL) \
+    PHP_FE(git2_graph_ahead_behind_many,NULL)
+
+#endif
+
+/*
+ * Local Variables:
+ * mode:c++
+ * indent-tabs-mode:nil
+ * tab-width:4
+ * End:
+ */
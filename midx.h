@@ -0,0 +1,209 @@
+/*
+ * midx.h
+ *
+ * Copyright (C) Roger P. Gee
+ */
+
+#ifndef PHPGIT2_MIDX_H
+#define PHPGIT2_MIDX_H
+
+namespace php_git2
+{
+    // Explicitly specialize git2_resource destructor for git_midx_writer.
+
+    template<> php_git_midx_writer::~git2_resource()
+    {
+        git_midx_writer_free(handle);
+    }
+
+    // Implements git2_odb_maintain_midx(). The multi-pack-index is (re)written
+    // when the repository has at least 'threshold' packs and the index is
+    // missing or not newer than the newest pack or pack index. Returns true if
+    // the index was written.
+
+    inline bool php_git2_odb_maintain_midx(git_repository* repo,zend_long threshold)
+    {
+        // NOTE: git_repository_commondir() always includes a trailing path
+        // separator.
+
+        std::string packDir = std::string(git_repository_commondir(repo)) + "objects/pack";
+        std::string midxPath = packDir + "/multi-pack-index";
+        zend_stat_t st;
+        int64_t newestPack = 0;
+        zend_long count = 0;
+        DIR* dir;
+        struct dirent* ent;
+
+        // Count the packs and find the newest pack file. Every pack has a
+        // corresponding index that is probed on lookup when there is no
+        // multi-pack-index. The directory mtime is not used since it also
+        // changes when unrelated files (e.g. temporary files) come and go.
+
+        dir = VCWD_OPENDIR(packDir.c_str());
+        if (dir == nullptr) {
+            return false;
+        }
+
+        while ((ent = readdir(dir)) != nullptr) {
+            size_t len = strlen(ent->d_name);
+            bool isPack;
+
+            isPack = (len > 5 && strcmp(ent->d_name + len - 5,".pack") == 0);
+            if (!isPack && (len <= 4 || strcmp(ent->d_name + len - 4,".idx") != 0)) {
+                continue;
+            }
+
+            if (isPack) {
+                count += 1;
+            }
+
+            std::string path = packDir + "/" + ent->d_name;
+            if (VCWD_STAT(path.c_str(),&st) == 0 && php_git2_stat_mtime(st) > newestPack) {
+                newestPack = php_git2_stat_mtime(st);
+            }
+        }
+
+        closedir(dir);
+
+        if (count < threshold) {
+            return false;
+        }
+
+        // The comparison is strict so that a pack written within the same
+        // timestamp tick as the index is not missed.
+
+        if (VCWD_STAT(midxPath.c_str(),&st) == 0 && php_git2_stat_mtime(st) > newestPack) {
+            return false;
+        }
+
+        int retval;
+        git_odb* odb;
+
+        retval = git_repository_odb(&odb,repo);
+        if (retval < 0) {
+            git_error(retval);
+        }
+
+        // Make sure the ODB knows about packs that arrived since it was loaded
+        // before writing the index.
+        retval = git_odb_refresh(odb);
+        if (retval == 0) {
+            retval = git_odb_write_multi_pack_index(odb);
+        }
+
+        git_odb_free(odb);
+
+        if (retval < 0) {
+            git_error(retval);
+        }
+
+        return true;
+    }
+
+} // namespace php_git2
+
+// Functions:
+
+static constexpr auto ZIF_GIT_MIDX_WRITER_NEW = zif_php_git2_function<
+    php_git2::func_wrapper<
+        int,
+        git_midx_writer**,
+        const char*>::func<git_midx_writer_new>,
+    php_git2::local_pack<
+        php_git2::php_resource_ref<php_git2::php_git_midx_writer>,
+        php_git2::php_string
+        >,
+    1,
+    php_git2::sequence<1>,
+    php_git2::sequence<0,1>
+    >;
+
+static constexpr auto ZIF_GIT_MIDX_WRITER_FREE = zif_php_git2_function_free<
+    php_git2::local_pack<
+        php_git2::php_resource_cleanup<php_git2::php_git_midx_writer>
+        >
+    >;
+
+static constexpr auto ZIF_GIT_MIDX_WRITER_ADD = zif_php_git2_function<
+    php_git2::func_wrapper<
+        int,
+        git_midx_writer*,
+        const char*>::func<git_midx_writer_add>,
+    php_git2::local_pack<
+        php_git2::php_resource<php_git2::php_git_midx_writer>,
+        php_git2::php_string
+        >
+    >;
+
+static constexpr auto ZIF_GIT_MIDX_WRITER_COMMIT = zif_php_git2_function<
+    php_git2::func_wrapper<
+        int,
+        git_midx_writer*>::func<git_midx_writer_commit>,
+    php_git2::local_pack<
+        php_git2::php_resource<php_git2::php_git_midx_writer>
+        >
+    >;
+
+static constexpr auto ZIF_GIT_MIDX_WRITER_DUMP = zif_php_git2_function<
+    php_git2::func_wrapper<
+        int,
+        git_buf*,
+        git_midx_writer*>::func<git_midx_writer_dump>,
+    php_git2::local_pack<
+        php_git2::php_git_buf,
+        php_git2::php_resource<php_git2::php_git_midx_writer>
+        >,
+    1,
+    php_git2::sequence<1>,
+    php_git2::sequence<0,1>
+    >;
+
+static PHP_FUNCTION(git2_odb_maintain_midx)
+{
+    php_git2::php_bailer bailer;
+
+    {
+        php_git2::php_resource<php_git2::php_git_repository> repo;
+        php_git2::php_bailout_context ctx(bailer);
+
+        if (BAILOUT_ENTER_REGION(ctx)) {
+            zval* zrepo;
+            zend_long threshold = 8;
+            if (zend_parse_parameters(ZEND_NUM_ARGS(),"z|l",&zrepo,&threshold) == FAILURE) {
+                return;
+            }
+
+            try {
+                repo.parse(zrepo,1);
+                RETVAL_BOOL(php_git2::php_git2_odb_maintain_midx(repo.byval_git2(),threshold));
+
+            } catch (php_git2::php_git2_exception_base& ex) {
+                php_git2::php_bailout_context ctx2(bailer);
+
+                if (BAILOUT_ENTER_REGION(ctx2)) {
+                    ex.handle();
+                }
+            }
+        }
+    }
+}
+
+// Function Entries:
+
+#define GIT_MIDX_FE                                                     \
+    PHP_GIT2_FE(git_midx_writer_new,ZIF_GIT_MIDX_WRITER_NEW,NULL)       \
+    PHP_GIT2_FE(git_midx_writer_free,ZIF_GIT_MIDX_WRITER_FREE,NULL)     \
+    PHP_GIT2_FE(git_midx_writer_add,ZIF_GIT_MIDX_WRITER_ADD,NULL)       \
+    PHP_GIT2_FE(git_midx_writer_commit,ZIF_GIT_MIDX_WRITER_COMMIT,NULL) \
+    PHP_GIT2_FE(git_midx_writer_dump,ZIF_GIT_MIDX_WRITER_DUMP,NULL)     \
+    PHP_FE(git2_odb_maintain_midx,NULL)
+
+#endif
+
+/*
+ * Local Variables:
+ * mode:c++
+ * indent-tabs-mode:nil
+ * tab-width:4
+ * End:
+ */
@@ -16,6 +16,48 @@ namespace php_git2
         git_object_free(handle);
     }
 
+    // Creates a resource of the specified type for each object looked up by
+    // git2_object_lookup_many(). The resources depend on the repository
+    // resource. A repeated OID is only looked up once.
+
+    template<typename GitResource>
+    void php_git2_object_lookup_many(zval* return_value,
+        php_resource<php_git_repository>& repo,
+        const git_oid* oids,
+        size_t count,
+        git_object_t type)
+    {
+        array_init_size(return_value,count);
+
+        for (size_t i = 0;i < count;++i) {
+            int retval;
+            git_object* object;
+            GitResource* rsrc;
+            zend_resource* zr;
+            zval zv;
+            char buf[GIT_OID_HEXSZ];
+            size_t buflen;
+
+            buflen = convert_oid_buffer(buf,oids + i);
+            if (zend_symtable_str_exists(Z_ARRVAL_P(return_value),buf,buflen)) {
+                continue;
+            }
+
+            retval = git_object_lookup(&object,repo.byval_git2(),oids + i,type);
+            if (retval < 0) {
+                git_error(retval);
+            }
+
+            rsrc = php_git2_create_resource<GitResource>();
+            rsrc->set_handle(reinterpret_cast<typename GitResource::git2_type>(object));
+            rsrc->set_parent(repo.get_object());
+            zr = zend_register_resource(rsrc,GitResource::resource_le());
+            ZVAL_RES(&zv,zr);
+
+            add_assoc_zval_ex(return_value,buf,buflen,&zv);
+        }
+    }
+
 } // namespace php_git2
 
 // Functions:
@@ -117,9 +159,9 @@ static constexpr auto ZIF_GIT_OBJECT_LOOKUP_PREFIX = zif_php_git2_function_setde
         php_git2::php_resource_ref<php_git2::php_git_object>,
         php_git2::php_resource<php_git2::php_git_repository>,
         php_git2::connector_wrapper<
-            php_git2::php_string_length_connector<size_t,php_git2::php_git_oid_fromstr>
+            php_git2::php_string_length_connector<size_t,php_git2::php_git_oid_prefix_fromhex>
             >,
-        php_git2::php_git_oid_fromstr,
+        php_git2::php_git_oid_prefix_fromhex,
         php_git2::php_long_cast<git_object_t>
         >,
     php_git2::sequence<0,1>,
@@ -197,6 +239,71 @@ static constexpr auto ZIF_GIT_OBJECT_TYPEISLOOSE = zif_php_git2_function_rethand
 
 // Function Entries:
 
+static PHP_FUNCTION(git2_object_lookup_many)
+{
+    php_git2::php_bailer bailer;
+
+    {
+        php_git2::php_resource<php_git2::php_git_repository> repo;
+        php_git2::php_bailout_context ctx(bailer);
+
+        if (BAILOUT_ENTER_REGION(ctx)) {
+            zval* zrepo;
+            zval* zoids;
+            zend_long type = GIT_OBJ_ANY;
+            git_oid* oids = nullptr;
+            size_t count;
+            if (zend_parse_parameters(ZEND_NUM_ARGS(),"za|l",&zrepo,&zoids,&type) == FAILURE) {
+                return;
+            }
+
+            try {
+                repo.parse(zrepo,1);
+                count = php_git2::convert_oid_array(&oids,zoids);
+
+                // Return resources of the specific object type if one was
+                // requested so that the type-specific functions accept them.
+
+                switch (type) {
+                case GIT_OBJ_COMMIT:
+                    php_git2::php_git2_object_lookup_many<php_git2::php_git_commit>(
+                        return_value,repo,oids,count,GIT_OBJ_COMMIT);
+                    break;
+                case GIT_OBJ_TREE:
+                    php_git2::php_git2_object_lookup_many<php_git2::php_git_tree>(
+                        return_value,repo,oids,count,GIT_OBJ_TREE);
+                    break;
+                case GIT_OBJ_BLOB:
+                    php_git2::php_git2_object_lookup_many<php_git2::php_git_blob>(
+                        return_value,repo,oids,count,GIT_OBJ_BLOB);
+                    break;
+                case GIT_OBJ_TAG:
+                    php_git2::php_git2_object_lookup_many<php_git2::php_git_tag>(
+                        return_value,repo,oids,count,GIT_OBJ_TAG);
+                    break;
+                default:
+                    php_git2::php_git2_object_lookup_many<php_git2::php_git_object>(
+                        return_value,repo,oids,count,static_cast<git_object_t>(type));
+                    break;
+                }
+
+                efree(oids);
+
+            } catch (php_git2::php_git2_exception_base& ex) {
+                php_git2::php_bailout_context ctx2(bailer);
+
+                if (oids != nullptr) {
+                    efree(oids);
+                }
+
+                if (BAILOUT_ENTER_REGION(ctx2)) {
+                    ex.handle();
+                }
+            }
+        }
+    }
+}
+
 #define GIT_OBJECT_FE                                                   \
     PHP_GIT2_FE(git_object_id,ZIF_GIT_OBJECT_ID,NULL)                   \
     PHP_GIT2_FE(git_object_lookup,ZIF_GIT_OBJECT_LOOKUP,NULL)           \
@@ -210,7 +317,8 @@ static constexpr auto ZIF_GIT_OBJECT_TYPEISLOOSE = zif_php_git2_function_rethand
     PHP_GIT2_FE(git_object_string2type,ZIF_GIT_OBJECT_STRING2TYPE,NULL) \
     PHP_GIT2_FE(git_object_type,ZIF_GIT_OBJECT_TYPE,NULL)               \
     PHP_GIT2_FE(git_object_type2string,ZIF_GIT_OBJECT_TYPE2STRING,NULL) \
-    PHP_GIT2_FE(git_object_typeisloose,ZIF_GIT_OBJECT_TYPEISLOOSE,NULL)
+    PHP_GIT2_FE(git_object_typeisloose,ZIF_GIT_OBJECT_TYPEISLOOSE,NULL) \
+    PHP_FE(git2_object_lookup_many,NULL)
 
 #endif
 
@@ -187,6 +187,47 @@ namespace php_git2
         connect_t& ownerWrapper;
     };
 
+    // Extracts the git_odb_backend from a GitODBBackend PHP value that is
+    // backed by a mempack backend (i.e. one created by git_mempack_new()). The
+    // state of the object is not changed.
+    class php_git_odb_backend_mempack:
+        public php_object<php_odb_backend_object>
+    {
+    public:
+        git_odb_backend* byval_git2()
+        {
+            php_odb_backend_object* object = get_storage();
+
+            // The mempack functions assume the backend is a mempack, so we
+            // compare against the read function of a reference mempack.
+            if (object->backend == nullptr
+                || object->kind == php_odb_backend_object::custom
+                || object->backend->read != mempack_read())
+            {
+                throw php_git2_exception("The ODB backend is not a mempack backend");
+            }
+
+            return object->backend;
+        }
+
+    private:
+        static decltype(git_odb_backend::read) mempack_read()
+        {
+            static decltype(git_odb_backend::read) fn = nullptr;
+
+            if (fn == nullptr) {
+                git_odb_backend* backend;
+
+                if (git_mempack_new(&backend) == 0) {
+                    fn = backend->read;
+                    backend->free(backend);
+                }
+            }
+
+            return fn;
+        }
+    };
+
     // Provide types that extract/bind git_odb_stream instances to/from a PHP
     // object of type GitODBStream. One class handles existing objects and the
     // other handles creating new ones.
@@ -378,6 +419,91 @@ namespace php_git2
         git_odb_expand_id* ids;
     };
 
+    // Reads a batch of objects from an ODB. This is the implementation of
+    // git2_odb_read_many().
+
+    inline void php_git2_odb_read_many(zval* return_value,git_odb* odb,zval* zoids,zval* zoptions)
+    {
+        git_oid* oids;
+        size_t count;
+        bool headerOnly = false;
+        bool ignoreMissing = false;
+
+        if (zoptions != nullptr) {
+            array_wrapper options(zoptions);
+
+            if (options.query("header_only",sizeof("header_only")-1)) {
+                headerOnly = options.get_bool();
+            }
+            if (options.query("ignore_missing",sizeof("ignore_missing")-1)) {
+                ignoreMissing = options.get_bool();
+            }
+        }
+
+        count = convert_oid_array(&oids,zoids);
+        array_init_size(return_value,count);
+
+        for (size_t i = 0;i < count;++i) {
+            int retval;
+            char buf[GIT_OID_HEXSZ];
+            size_t buflen;
+            zval zentry;
+
+            // A repeated OID is only read once.
+            buflen = convert_oid_buffer(buf,oids + i);
+            if (zend_symtable_str_exists(Z_ARRVAL_P(return_value),buf,buflen)) {
+                continue;
+            }
+
+            if (headerOnly) {
+                size_t size;
+                git_otype type;
+
+                retval = git_odb_read_header(&size,&type,odb,oids + i);
+                if (retval == 0) {
+                    array_init_size(&zentry,2);
+                    add_assoc_long_ex(&zentry,"type",sizeof("type")-1,type);
+                    add_assoc_long_ex(&zentry,"size",sizeof("size")-1,size);
+                }
+            }
+            else {
+                git_odb_object* object;
+
+                retval = git_odb_read(&object,odb,oids + i);
+                if (retval == 0) {
+                    array_init_size(&zentry,3);
+                    add_assoc_long_ex(&zentry,
+                        "type",
+                        sizeof("type")-1,
+                        git_odb_object_type(object));
+                    add_assoc_long_ex(&zentry,
+                        "size",
+                        sizeof("size")-1,
+                        git_odb_object_size(object));
+                    add_assoc_stringl_ex(&zentry,
+                        "data",
+                        sizeof("data")-1,
+                        (const char*)git_odb_object_data(object),
+                        git_odb_object_size(object));
+                    git_odb_object_free(object);
+                }
+            }
+
+            if (retval == GIT_ENOTFOUND && ignoreMissing) {
+                giterr_clear();
+                continue;
+            }
+            if (retval < 0) {
+                efree(oids);
+                git_error(retval);
+            }
+
+            add_assoc_zval_ex(return_value,buf,buflen,&zentry);
+        }
+
+        efree(oids);
+    }
+
 } // namespace php_git2
 
 // Functions:
@@ -511,9 +637,9 @@ static constexpr auto ZIF_GIT_ODB_READ_PREFIX = zif_php_git2_function_setdeps<
         php_git2::php_resource_ref<php_git2::php_git_odb_object>,
         php_git2::php_resource<php_git2::php_git_odb>,
         php_git2::connector_wrapper<
-            php_git2::php_string_length_connector<size_t,php_git2::php_git_oid_fromstr>
+            php_git2::php_string_length_connector<size_t,php_git2::php_git_oid_prefix_fromhex>
             >,
-        php_git2::php_git_oid_fromstr
+        php_git2::php_git_oid_prefix_fromhex
         >,
     php_git2::sequence<0,1>,
     1,
@@ -640,6 +766,46 @@ static constexpr auto ZIF_GIT_ODB_BACKEND_ONE_PACK = zif_php_git2_function<
     php_git2::sequence<0,1>
     >;
 
+static constexpr auto ZIF_GIT_MEMPACK_NEW = zif_php_git2_function<
+    php_git2::func_wrapper<
+        int,
+        git_odb_backend**
+        >::func<git_mempack_new>,
+    php_git2::local_pack<
+        php_git2::php_git_odb_backend_byref
+        >,
+    1,
+    php_git2::sequence<>,
+    php_git2::sequence<0>
+    >;
+
+static constexpr auto ZIF_GIT_MEMPACK_DUMP = zif_php_git2_function<
+    php_git2::func_wrapper<
+        int,
+        git_buf*,
+        git_repository*,
+        git_odb_backend*
+        >::func<git_mempack_dump>,
+    php_git2::local_pack<
+        php_git2::php_git_buf,
+        php_git2::php_resource<php_git2::php_git_repository>,
+        php_git2::php_git_odb_backend_mempack
+        >,
+    1,
+    php_git2::sequence<1,2>,
+    php_git2::sequence<0,1,2>
+    >;
+
+static constexpr auto ZIF_GIT_MEMPACK_RESET = zif_php_git2_function<
+    php_git2::func_wrapper<
+        int,
+        git_odb_backend*
+        >::func<git_mempack_reset>,
+    php_git2::local_pack<
+        php_git2::php_git_odb_backend_mempack
+        >
+    >;
+
 static constexpr auto ZIF_GIT_ODB_OPEN_RSTREAM = zif_php_git2_function<
     php_git2::func_wrapper<
         int,
@@ -803,9 +969,9 @@ static constexpr auto ZIF_GIT_ODB_EXISTS_PREFIX = zif_php_git2_function<
         php_git2::php_git_oid,
         php_git2::php_resource<php_git2::php_git_odb>,
         php_git2::connector_wrapper<
-            php_git2::php_string_length_connector<size_t,php_git2::php_git_oid_fromstr>
+            php_git2::php_string_length_connector<size_t,php_git2::php_git_oid_prefix_fromhex>
             >,
-        php_git2::php_git_oid_fromstr
+        php_git2::php_git_oid_prefix_fromhex
         >,
     1,
     php_git2::sequence<1,3>,
@@ -858,6 +1024,16 @@ static constexpr auto ZIF_GIT_ODB_REFRESH = zif_php_git2_function<
         >
     >;
 
+static constexpr auto ZIF_GIT_ODB_WRITE_MULTI_PACK_INDEX = zif_php_git2_function<
+    php_git2::func_wrapper<
+        int,
+        git_odb*
+        >::func<git_odb_write_multi_pack_index>,
+    php_git2::local_pack<
+        php_git2::php_resource<php_git2::php_git_odb>
+        >
+    >;
+
 static constexpr auto ZIF_GIT_ODB_GET_BACKEND = zif_php_git2_function<
     php_git2::func_wrapper<
         int,
@@ -922,6 +1098,214 @@ static constexpr auto ZIF_GIT_ODB_HASHFILE = zif_php_git2_function<
     php_git2::sequence<1,2>
     >;
 
+#ifdef HAVE_GIT2_SQLITE
+
+static PHP_FUNCTION(git2_odb_backend_sqlite)
+{
+    php_git2::php_bailer bailer;
+    php_git2::php_bailout_context ctx(bailer);
+
+    if (BAILOUT_ENTER_REGION(ctx)) {
+        char* path;
+        size_t pathLength;
+        zend_long busyTimeout = GIT2_G(sqliteBusyTimeout);
+        if (zend_parse_parameters(ZEND_NUM_ARGS(),"p|l",&path,&pathLength,&busyTimeout) == FAILURE) {
+            return;
+        }
+
+        try {
+            git_odb_backend* backend;
+            int retval;
+
+            if (busyTimeout < 0 || busyTimeout > INT_MAX) {
+                throw php_git2::php_git2_error_exception("Busy timeout is out of range");
+            }
+
+            retval = php_git2::php_git2_odb_backend_sqlite(&backend,
+                path,
+                static_cast<int>(busyTimeout));
+            if (retval < 0) {
+                php_git2::git_error(retval);
+            }
+
+            php_git2::php_git2_make_odb_backend(return_value,backend,nullptr);
+
+        } catch (php_git2::php_git2_exception_base& ex) {
+            php_git2::php_bailout_context ctx2(bailer);
+
+            if (BAILOUT_ENTER_REGION(ctx2)) {
+                ex.handle();
+            }
+        }
+    }
+}
+
+#define GIT2_ODB_BACKEND_SQLITE_FE \
+    PHP_FE(git2_odb_backend_sqlite,NULL)
+
+#else
+
+#define GIT2_ODB_BACKEND_SQLITE_FE
+
+#endif
+
+static PHP_FUNCTION(git2_odb_read_many)
+{
+    php_git2::php_bailer bailer;
+
+    {
+        php_git2::php_resource<php_git2::php_git_odb> odb;
+        php_git2::php_bailout_context ctx(bailer);
+
+        if (BAILOUT_ENTER_REGION(ctx)) {
+            zval* zodb;
+            zval* zoids;
+            zval* zoptions = nullptr;
+            if (zend_parse_parameters(ZEND_NUM_ARGS(),"za|a!",&zodb,&zoids,&zoptions) == FAILURE) {
+                return;
+            }
+
+            try {
+                odb.parse(zodb,1);
+                php_git2::php_git2_odb_read_many(return_value,odb.byval_git2(),zoids,zoptions);
+
+            } catch (php_git2::php_git2_exception_base& ex) {
+                php_git2::php_bailout_context ctx2(bailer);
+
+                if (BAILOUT_ENTER_REGION(ctx2)) {
+                    ex.handle();
+                }
+            }
+        }
+    }
+}
+
+static PHP_FUNCTION(git2_odb_stream)
+{
+    php_git2::php_bailer bailer;
+
+    {
+        php_git2::php_git_odb_stream_byval odbStream;
+        php_git2::php_bailout_context ctx(bailer);
+
+        if (BAILOUT_ENTER_REGION(ctx)) {
+            zval* zvp;
+            git_odb_stream* handle;
+            php_stream* stream;
+            if (zend_parse_parameters(ZEND_NUM_ARGS(),"z",&zvp) == FAILURE) {
+                return;
+            }
+
+            try {
+                odbStream.parse(zvp,1);
+
+                handle = odbStream.byval_git2();
+                if (handle == nullptr) {
+                    throw php_git2::php_git2_error_exception("The ODB stream is not open");
+                }
+
+                // The stream holds a reference to the GitODBStream object so
+                // that the underlying git_odb_stream outlives the PHP stream.
+                stream = php_git2::php_git2_make_odb_read_stream(zvp,handle);
+                if (stream == nullptr) {
+                    RETURN_FALSE;
+                }
+
+                php_stream_to_zval(stream,return_value);
+
+            } catch (php_git2::php_git2_exception_base& ex) {
+                php_git2::php_bailout_context ctx2(bailer);
+
+                if (BAILOUT_ENTER_REGION(ctx2)) {
+                    ex.handle();
+                }
+            }
+        }
+    }
+}
+
+static PHP_FUNCTION(git2_odb_backend_set_cache)
+{
+    php_git2::php_bailer bailer;
+
+    {
+        php_git2::php_object<php_git2::php_odb_backend_object> backend;
+        php_git2::php_bailout_context ctx(bailer);
+
+        if (BAILOUT_ENTER_REGION(ctx)) {
+            zval* zbackend;
+            zend_long maxBytes;
+            if (zend_parse_parameters(ZEND_NUM_ARGS(),"zl",&zbackend,&maxBytes) == FAILURE) {
+                return;
+            }
+
+            try {
+                backend.parse(zbackend,1);
+
+                // Only custom backends consult the cache, so refuse backends
+                // implemented by libgit2 (GitODBBackend_Internal) instead of
+                // silently ignoring the setting.
+                php_git2::php_odb_backend_object* object = backend.get_storage();
+                if (object->kind == php_git2::php_odb_backend_object::conventional
+                    || object->kind == php_git2::php_odb_backend_object::user)
+                {
+                    throw php_git2::php_git2_error_exception(
+                        "The ODB backend cache is only available for custom backends");
+                }
+
+                if (maxBytes < 0) {
+                    throw php_git2::php_git2_error_exception("Cache size must not be negative");
+                }
+
+                object->cache.set_capacity(static_cast<size_t>(maxBytes));
+
+            } catch (php_git2::php_git2_exception_base& ex) {
+                php_git2::php_bailout_context ctx2(bailer);
+
+                if (BAILOUT_ENTER_REGION(ctx2)) {
+                    ex.handle();
+                }
+            }
+        }
+    }
+}
+
+static PHP_FUNCTION(git2_odb_backend_cache_stats)
+{
+    php_git2::php_bailer bailer;
+
+    {
+        php_git2::php_object<php_git2::php_odb_backend_object> backend;
+        php_git2::php_bailout_context ctx(bailer);
+
+        if (BAILOUT_ENTER_REGION(ctx)) {
+            zval* zbackend;
+            if (zend_parse_parameters(ZEND_NUM_ARGS(),"z",&zbackend) == FAILURE) {
+                return;
+            }
+
+            try {
+                zval zprefetch;
+                php_git2::php_odb_backend_object* object;
+
+                backend.parse(zbackend,1);
+                object = backend.get_storage();
+
+                object->cache.get_stats(return_value);
+                object->prefetch.get_stats(&zprefetch);
+                add_assoc_zval_ex(return_value,"prefetch",sizeof("prefetch")-1,&zprefetch);
+
+            } catch (php_git2::php_git2_exception_base& ex) {
+                php_git2::php_bailout_context ctx2(bailer);
+
+                if (BAILOUT_ENTER_REGION(ctx2)) {
+                    ex.handle();
+                }
+            }
+        }
+    }
+}
+
 // Function Entries:
 
 #define GIT_ODB_FE                                                      \
@@ -941,6 +1325,9 @@ static constexpr auto ZIF_GIT_ODB_HASHFILE = zif_php_git2_function<
     PHP_GIT2_FE(git_odb_object_dup,ZIF_GIT_ODB_OBJECT_DUP,NULL)         \
     PHP_GIT2_FE(git_odb_backend_pack,ZIF_GIT_ODB_BACKEND_PACK,NULL)     \
     PHP_GIT2_FE(git_odb_backend_loose,ZIF_GIT_ODB_BACKEND_LOOSE,NULL)   \
+    PHP_GIT2_FE(git_mempack_new,ZIF_GIT_MEMPACK_NEW,NULL)               \
+    PHP_GIT2_FE(git_mempack_dump,ZIF_GIT_MEMPACK_DUMP,NULL)             \
+    PHP_GIT2_FE(git_mempack_reset,ZIF_GIT_MEMPACK_RESET,NULL)           \
     PHP_GIT2_FE(git_odb_backend_one_pack,ZIF_GIT_ODB_BACKEND_ONE_PACK,NULL) \
     PHP_GIT2_FE(git_odb_open_rstream,ZIF_GIT_ODB_OPEN_RSTREAM,git_odb_open_rstream_arginfo) \
     PHP_GIT2_FE(git_odb_open_wstream,ZIF_GIT_ODB_OPEN_WSTREAM,NULL)     \
@@ -955,10 +1342,16 @@ static constexpr auto ZIF_GIT_ODB_HASHFILE = zif_php_git2_function<
     PHP_GIT2_FE(git_odb_expand_ids,ZIF_GIT_ODB_EXPAND_IDS,NULL)         \
     PHP_GIT2_FE(git_odb_foreach,ZIF_GIT_ODB_FOREACH,NULL)               \
     PHP_GIT2_FE(git_odb_refresh,ZIF_GIT_ODB_REFRESH,NULL)               \
+    PHP_GIT2_FE(git_odb_write_multi_pack_index,ZIF_GIT_ODB_WRITE_MULTI_PACK_INDEX,NULL) \
     PHP_GIT2_FE(git_odb_get_backend,ZIF_GIT_ODB_GET_BACKEND,NULL)       \
     PHP_GIT2_FE(git_odb_num_backends,ZIF_GIT_ODB_NUM_BACKENDS,NULL)     \
     PHP_GIT2_FE(git_odb_hash,ZIF_GIT_ODB_HASH,NULL)                     \
-    PHP_GIT2_FE(git_odb_hashfile,ZIF_GIT_ODB_HASHFILE,NULL)
+    PHP_GIT2_FE(git_odb_hashfile,ZIF_GIT_ODB_HASHFILE,NULL)             \
+    PHP_FE(git2_odb_stream,NULL)                                        \
+    PHP_FE(git2_odb_read_many,NULL)                                     \
+    PHP_FE(git2_odb_backend_set_cache,NULL)                             \
+    PHP_FE(git2_odb_backend_cache_stats,NULL)                           \
+    GIT2_ODB_BACKEND_SQLITE_FE
 
 #endif
 
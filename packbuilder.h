@@ -47,6 +47,113 @@ namespace php_git2
         php_callback_sync* cb;
     };
 
+    // Writes pack data produced by git_packbuilder_foreach() directly to a PHP
+    // stream or to the SAPI output layer. Small chunks are coalesced into a
+    // buffer so that the target sees fewer, larger writes. This is the
+    // implementation of git2_packbuilder_output().
+
+    class php_git2_pack_output
+    {
+    public:
+        php_git2_pack_output(php_stream* target,size_t bufferSize):
+            stream(target), buffer(nullptr), capacity(bufferSize), used(0),
+            total(0)
+        {
+            if (capacity > 0) {
+                buffer = reinterpret_cast<char*>(emalloc(capacity));
+            }
+        }
+
+        ~php_git2_pack_output()
+        {
+            if (buffer != nullptr) {
+                efree(buffer);
+            }
+        }
+
+        void run(git_packbuilder* pb)
+        {
+            int retval;
+
+            retval = git_packbuilder_foreach(pb,callback,this);
+            if (retval == 0 && !flush()) {
+                retval = GIT_EPHP;
+            }
+
+            if (retval < 0) {
+                git_error(retval);
+            }
+        }
+
+        size_t get_total() const
+        {
+            return total;
+        }
+
+    private:
+        static int callback(void* buf,size_t size,void* payload)
+        {
+            php_git2_pack_output* output = reinterpret_cast<php_git2_pack_output*>(payload);
+            const char* data = reinterpret_cast<const char*>(buf);
+
+            // Chunks that do not fit in the remaining buffer space flush the
+            // buffer. Chunks at least as large as the buffer bypass it.
+
+            if (output->used + size > output->capacity) {
+                if (!output->flush()) {
+                    return GIT_EPHP;
+                }
+
+                if (size >= output->capacity) {
+                    return output->write(data,size) ? GIT_OK : GIT_EPHP;
+                }
+            }
+
+            memcpy(output->buffer + output->used,data,size);
+            output->used += size;
+
+            return GIT_OK;
+        }
+
+        bool flush()
+        {
+            if (used > 0) {
+                size_t n = used;
+
+                used = 0;
+                return write(buffer,n);
+            }
+
+            return true;
+        }
+
+        bool write(const char* data,size_t size)
+        {
+            size_t n;
+
+            if (stream != nullptr) {
+                n = static_cast<size_t>(php_stream_write(stream,data,size));
+            }
+            else {
+                n = php_output_write(data,size);
+            }
+
+            if (n != size) {
+                giterr_set_str(GITERR_OS,"Failed to write pack data to output");
+                return false;
+            }
+
+            total += n;
+            return true;
+        }
+
+        php_stream* stream;
+        char* buffer;
+        size_t capacity;
+        size_t used;
+        size_t total;
+    };
+
 } // namespace php_git2
 
 // Functions:
@@ -207,6 +314,20 @@ static constexpr auto ZIF_GIT_PACKBUILDER_OBJECT_COUNT = zif_php_git2_function<
     0
     >;
 
+static constexpr auto ZIF_GIT_PACKBUILDER_WRITE_BUF = zif_php_git2_function<
+    php_git2::func_wrapper<
+        int,
+        git_buf*,
+        git_packbuilder*>::func<git_packbuilder_write_buf>,
+    php_git2::local_pack<
+        php_git2::php_git_buf,
+        php_git2::php_resource<php_git2::php_git_packbuilder>
+        >,
+    1,
+    php_git2::sequence<1>,
+    php_git2::sequence<0,1>
+    >;
+
 static constexpr auto ZIF_GIT_PACKBUILDER_WRITE = zif_php_git2_function<
     php_git2::func_wrapper<
         int,
@@ -241,6 +362,50 @@ static constexpr auto ZIF_GIT_PACKBUILDER_WRITTEN = zif_php_git2_function<
     0
     >;
 
+static PHP_FUNCTION(git2_packbuilder_output)
+{
+    php_git2::php_bailer bailer;
+
+    {
+        php_git2::php_resource<php_git2::php_git_packbuilder> pb;
+        php_git2::php_bailout_context ctx(bailer);
+
+        if (BAILOUT_ENTER_REGION(ctx)) {
+            zval* zpb;
+            zval* ztarget = nullptr;
+            zend_long bufferSize = 65536;
+            php_stream* stream = nullptr;
+            if (zend_parse_parameters(ZEND_NUM_ARGS(),"z|r!l",&zpb,&ztarget,&bufferSize) == FAILURE) {
+                return;
+            }
+
+            if (ztarget != nullptr) {
+                php_stream_from_zval(stream,ztarget);
+            }
+
+            try {
+                pb.parse(zpb,1);
+
+                if (bufferSize < 0) {
+                    throw php_git2::php_git2_error_exception("Buffer size must not be negative");
+                }
+
+                php_git2::php_git2_pack_output output(stream,static_cast<size_t>(bufferSize));
+                output.run(pb.byval_git2());
+
+                RETVAL_LONG(static_cast<zend_long>(output.get_total()));
+
+            } catch (php_git2::php_git2_exception_base& ex) {
+                php_git2::php_bailout_context ctx2(bailer);
+
+                if (BAILOUT_ENTER_REGION(ctx2)) {
+                    ex.handle();
+                }
+            }
+        }
+    }
+}
+
 // Function Entries:
 
 #define GIT_PACKBUILDER_FE                                              \
@@ -257,7 +422,9 @@ static constexpr auto ZIF_GIT_PACKBUILDER_WRITTEN = zif_php_git2_function<
     PHP_GIT2_FE(git_packbuilder_set_callbacks,ZIF_GIT_PACKBUILDER_SET_CALLBACKS,NULL) \
     PHP_GIT2_FE(git_packbuilder_object_count,ZIF_GIT_PACKBUILDER_OBJECT_COUNT,NULL) \
     PHP_GIT2_FE(git_packbuilder_write,ZIF_GIT_PACKBUILDER_WRITE,NULL)   \
-    PHP_GIT2_FE(git_packbuilder_written,ZIF_GIT_PACKBUILDER_WRITTEN,NULL)
+    PHP_GIT2_FE(git_packbuilder_write_buf,ZIF_GIT_PACKBUILDER_WRITE_BUF,NULL) \
+    PHP_GIT2_FE(git_packbuilder_written,ZIF_GIT_PACKBUILDER_WRITTEN,NULL) \
+    PHP_FE(git2_packbuilder_output,NULL)
 
 #endif
 
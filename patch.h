@@ -259,12 +259,9 @@ static constexpr auto ZIF_GIT_PATCH_PRINT = zif_php_git2_function<
         void*>::func<git_patch_print>,
     php_git2::local_pack<
         php_git2::php_resource<php_git2::php_git_patch>,
-        php_git2::php_callback_handler<php_git2::diff_line_callback>,
-        php_git2::php_callback_sync
-        >,
-    -1,
-    php_git2::sequence<0,2,2>, // pass callback in twice for function and payload
-    php_git2::sequence<0,1,2>
+        php_git2::diff_line_callback_connector,
+        php_git2::php_git_diff_callback_payload
+        >
     >;
 
 static constexpr auto ZIF_GIT_PATCH_SIZE = zif_php_git2_function<
@@ -53,9 +53,67 @@ int php_git2::php_git2_invoke_callback(
     return result;
 }
 
+int php_git2::php_git2_invoke_callback(
+    php_callback_base* cb,
+    zval* ret,
+    int paramCount,
+    zval params[])
+{
+    zend_fcall_info_cache* fcc = cb->get_fcall_cache();
+
+    // Fall back to resolving the callable if no cached function is available.
+    if (fcc->function_handler == nullptr) {
+        return php_git2_invoke_callback(nullptr,cb->get_value(),ret,paramCount,params);
+    }
+
+    php_bailer bailer;
+    php_bailout_context ctx(bailer);
+    int result = GIT_OK;
+
+    ZVAL_NULL(ret);
+
+    if (BAILOUT_ENTER_REGION(ctx)) {
+        int retval;
+        zend_fcall_info fci = empty_fcall_info;
+
+        fci.size = sizeof(fci);
+        ZVAL_COPY_VALUE(&fci.function_name,cb->get_value());
+        fci.retval = ret;
+        fci.params = params;
+        fci.param_count = paramCount;
+        fci.no_separation = 1;
+
+        retval = zend_call_function(&fci,fcc);
+        if (retval == FAILURE) {
+            php_git2_giterr_set(GITERR_INVALID,"Failed to invoke userspace callback");
+            result = GIT_EPHP_ERROR;
+        }
+        else {
+            php_exception_wrapper ex;
+
+            // Handle case where PHP userspace threw an exception.
+            if (ex.has_exception()) {
+                ex.set_giterr();
+                result = GIT_EPHP_PROP;
+            }
+        }
+    }
+    else {
+        // Set a libgit2 error for completeness.
+        php_git2_giterr_set(GITERR_INVALID,"PHP reported a fatal error");
+
+        // Allow the bailout error to propogate.
+        result = GIT_EPHP_PROP_BAILOUT;
+        bailer.handled();
+    }
+
+    return result;
+}
+
 // php_callback_base
 
-php_callback_base::php_callback_base()
+php_callback_base::php_callback_base():
+    fcc(empty_fcall_info_cache)
 {
     ZVAL_NULL(&data);
 }
@@ -87,6 +145,13 @@ void php_callback_base::parse_impl(zval* zvp,int argno)
         }
 
         ZVAL_COPY(&value,&fci.function_name);
+
+        // Keep the resolved function so that invocations do not have to
+        // resolve the callable again. Trampolines (e.g. __call) are released
+        // after a single call, so they cannot be cached.
+        if (!(fcc.function_handler->common.fn_flags & ZEND_ACC_CALL_VIA_TRAMPOLINE)) {
+            this->fcc = fcc;
+        }
     }
     else {
         // Copy payload argument.
@@ -160,7 +225,7 @@ packbuilder_foreach_callback::callback(void* buf,size_t size,void* payload)
 
     params.assign<0>(buf,size,size,data);
 
-    result = params.call(func,&retval);
+    result = params.call(cb,&retval);
     zval_ptr_dtor(&retval);
 
     return result;
@@ -185,7 +250,7 @@ transfer_progress_callback::callback(const git_transfer_progress* stats,void* pa
     params.assign<1>(cb->get_payload());
     php_git2::convert_transfer_progress(zstats,stats);
 
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
 
     if (result == 0) {
         if (Z_TYPE(retval) == IS_FALSE) {
@@ -215,7 +280,7 @@ odb_foreach_callback::callback(const git_oid* oid,void* payload)
     convert_oid(params[0],oid);
     params.assign<1>(cb->get_payload());
 
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
 
     if (result == GIT_OK) {
         // False means stop iteration.
@@ -248,7 +313,7 @@ treewalk_callback::callback(const char* root,const git_tree_entry* entry,void* p
     res.ret(params[1]);
     params.assign<2>(std::forward<zval*>(cb->get_payload()));
 
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
     zval_ptr_dtor(&retval);
 
     return result;
@@ -272,7 +337,7 @@ commit_parent_callback::callback(size_t idx,void* payload)
     params.assign<0>(idx,cb->get_payload());
 
     // Call the userspace callback.
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
 
     // Handle errors. It is unclear how this callback is to report errors (if at
     // all), so we just report end of operation.
@@ -321,7 +386,7 @@ int reference_foreach_callback::callback(git_reference* ref,void* payload)
     params.assign<1>(cb->get_payload());
 
     // Call the userspace callback.
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
     zval_ptr_dtor(&retval);
 
     return result;
@@ -341,7 +406,7 @@ int reference_foreach_name_callback::callback(const char* name,void* payload)
     params.assign<0>(name,cb->get_payload());
 
     // Call the userspace callback.
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
     zval_ptr_dtor(&retval);
 
     return result;
@@ -368,7 +433,7 @@ int packbuilder_progress_callback::callback(int stage,
         cb->get_payload());
 
     // Call the userspace callback.
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
     zval_ptr_dtor(&retval);
 
     return result;
@@ -394,7 +459,7 @@ int config_foreach_callback::callback(const git_config_entry* entry,void* payloa
     add_assoc_long(zentry,"level",entry->level);
 
     // Call the userspace callback.
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
     if (result == GIT_OK) {
         convert_to_boolean(&retval);
         result = Z_TYPE(retval) == IS_TRUE;
@@ -412,13 +477,13 @@ int tag_foreach_callback::callback(const char* name,git_oid* oid,void* payload)
 
     int result;
     zval retval;
-    char buf[GIT_OID_HEXSZ+1];
     zval_array<3> params;
 
-    git_oid_tostr(buf,sizeof(buf),oid);
-    params.assign<0>(name,buf,cb->get_payload());
+    params.assign<0>(name);
+    convert_oid(params[1],oid);
+    params.assign<2>(cb->get_payload());
 
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
     zval_ptr_dtor(&retval);
 
     return result;
@@ -438,7 +503,7 @@ int repository_create_callback::callback(git_repository** out,
     zval_array<3> params;
 
     params.assign<0>(path,static_cast<bool>(bare),cb->get_payload());
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
 
     // Handle errors from userspace.
     if (result < 0) {
@@ -512,7 +577,7 @@ void checkout_progress_callback::callback(
     zval_array<4> params;
 
     params.assign<0>(path,completedSteps,totalSteps,cb->get_payload());
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
 
     UNUSED(result);
 }
@@ -539,7 +604,7 @@ int diff_notify_callback::callback(
     diffRes.ret(params[0]);
     convert_diff_delta(params[1],delta_to_add);
     params.assign<2>(matched_pathspec,cb->get_payload());
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
 
     // Handle errors. It is unclear how this callback is to report errors (if at
     // all), so we just report end of operation.
@@ -582,7 +647,7 @@ int diff_progress_callback::callback(
     *diffRes.byval_git2() = diff_so_far;
     diffRes.ret(params[0]);
     params.assign<1>(old_path,new_path,cb->get_payload());
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
 
     // Handle errors. It is unclear how this callback is to report errors (if at
     // all), so we just report end of operation.
@@ -611,6 +676,40 @@ int diff_progress_callback::callback(
     return result;
 }
 
+// git_diff_callback_info
+
+zval* git_diff_callback_info::get_delta(const git_diff_delta* delta)
+{
+    if (delta == nullptr) {
+        return nullptr;
+    }
+
+    if (delta != lastDelta || memcmp(delta,&deltaCopy,sizeof(git_diff_delta)) != 0) {
+        zval_ptr_dtor(&zdelta);
+        convert_diff_delta(&zdelta,delta);
+        lastDelta = delta;
+        memcpy(&deltaCopy,delta,sizeof(git_diff_delta));
+    }
+
+    return &zdelta;
+}
+
+zval* git_diff_callback_info::get_hunk(const git_diff_hunk* hunk)
+{
+    if (hunk == nullptr) {
+        return nullptr;
+    }
+
+    if (hunk != lastHunk || memcmp(hunk,&hunkCopy,sizeof(git_diff_hunk)) != 0) {
+        zval_ptr_dtor(&zhunk);
+        convert_diff_hunk(&zhunk,hunk);
+        lastHunk = hunk;
+        memcpy(&hunkCopy,hunk,sizeof(git_diff_hunk));
+    }
+
+    return &zhunk;
+}
+
 // diff_file_callback
 
 int diff_file_callback::callback(const git_diff_delta* delta,float progress,void* payload)
@@ -625,9 +724,8 @@ int diff_file_callback::callback(const git_diff_delta* delta,float progress,void
     zval retval;
     zval_array<3> params;
 
-    convert_diff_delta(params[0],delta);
-    params.assign<1>(progress,info->zpayload);
-    result = params.call(cb->get_value(),&retval);
+    params.assign<0>(info->get_delta(delta),progress,info->zpayload);
+    result = params.call(cb,&retval);
     zval_ptr_dtor(&retval);
 
     return result;
@@ -649,10 +747,10 @@ int diff_binary_callback::callback(const git_diff_delta* delta,
     zval retval;
     zval_array<3> params;
 
-    convert_diff_delta(params[0],delta);
+    params.assign<0>(info->get_delta(delta));
     convert_diff_binary(params[1],binary);
     params.assign<2>(info->zpayload);
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
     zval_ptr_dtor(&retval);
 
     return result;
@@ -674,10 +772,8 @@ int diff_hunk_callback::callback(const git_diff_delta* delta,
     zval retval;
     zval_array<3> params;
 
-    convert_diff_delta(params[0],delta);
-    convert_diff_hunk(params[1],hunk);
-    params.assign<2>(info->zpayload);
-    result = params.call(cb->get_value(),&retval);
+    params.assign<0>(info->get_delta(delta),info->get_hunk(hunk),info->zpayload);
+    result = params.call(cb,&retval);
     zval_ptr_dtor(&retval);
 
     return result;
@@ -700,11 +796,10 @@ int diff_line_callback::callback(const git_diff_delta* delta,
     zval retval;
     zval_array<4> params;
 
-    convert_diff_delta(params[0],delta);
-    convert_diff_hunk(params[1],hunk);
+    params.assign<0>(info->get_delta(delta),info->get_hunk(hunk));
     convert_diff_line(params[2],line);
     params.assign<3>(info->zpayload);
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
     zval_ptr_dtor(&retval);
 
     return result;
@@ -723,7 +818,7 @@ int index_matched_path_callback::callback(const char* path,
     zval_array<3> params;
 
     params.assign<0>(path,matched_pathspec,cb->get_payload());
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
 
     // Handle errors. It is unclear how this callback is to report errors (if at
     // all), so we just report end of operation.
@@ -755,12 +850,11 @@ int revwalk_hide_callback::callback(const git_oid* commit_id,void* payload)
     int result;
     zval retval;
     zval_array<2> params;
-    char buf[GIT_OID_HEXSZ + 1];
 
-    git_oid_tostr(buf,sizeof(buf),commit_id);
-    params.assign<0>(buf,cb->get_payload());
+    convert_oid(params[0],commit_id);
+    params.assign<1>(cb->get_payload());
 
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
     zval_ptr_dtor(&retval);
 
     return result;
@@ -799,7 +893,7 @@ int attr_foreach_callback::callback(const char* name,const char* value,void* pay
     // accordingly.
     params.assign<0>(name,value,cb->get_payload());
 
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
     zval_ptr_dtor(&retval);
 
     return result;
@@ -817,7 +911,7 @@ int status_callback::callback(const char* path,unsigned int status_flags,void* p
 
     params.assign<0>(path,status_flags,cb->get_payload());
 
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
     zval_ptr_dtor(&retval);
 
     return result;
@@ -833,15 +927,12 @@ int note_foreach_callback::callback(const git_oid* blob_id,
     int result;
     zval retval;
     zval_array<3> params;
-    char buf[GIT_OID_HEXSZ + 1];
 
-    git_oid_tostr(buf,sizeof(buf),blob_id);
-    ZVAL_STRING(params[0],buf);
-    git_oid_tostr(buf,sizeof(buf),annotated_object_id);
-    ZVAL_STRING(params[1],buf);
+    convert_oid(params[0],blob_id);
+    convert_oid(params[1],annotated_object_id);
     params.assign<2>(cb->get_payload());
 
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
     zval_ptr_dtor(&retval);
 
     return result;
@@ -859,14 +950,12 @@ int stash_callback::callback(size_t index,
     int result;
     zval retval;
     zval_array<4> params;
-    char buf[GIT_OID_HEXSZ + 1];
 
     params.assign<0>(index,message);
-    git_oid_tostr(buf,sizeof(buf),stash_id);
-    ZVAL_STRING(params[2],buf);
+    convert_oid(params[2],stash_id);
     params.assign<3>(cb->get_payload());
 
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
 
     if (result == GIT_OK) {
         if (Z_TYPE(retval) != IS_NULL) {
@@ -893,7 +982,7 @@ int stash_apply_progress_callback::callback(
     zval_array<2> params;
 
     params.assign<0>(static_cast<long>(progress),cb->get_payload());
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
 
     if (result == GIT_OK) {
         if (Z_TYPE(retval) != IS_NULL) {
@@ -922,7 +1011,7 @@ int cred_acquire_callback::callback(git_cred** cred,
     zval_array<4> params;
 
     params.assign<0>(url,username_from_url,allowed_types,cb->get_payload());
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
 
     if (result == GIT_OK) {
         if (Z_TYPE(retval) == IS_RESOURCE) {
@@ -982,7 +1071,7 @@ int transport_certificate_check_callback::callback(git_cert* cert,
 
     convert_cert(params[0],cert);
     params.assign<1>(static_cast<bool>(valid),host,cb->get_payload());
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
 
     if (result == GIT_OK) {
         convert_to_boolean(&retval);
@@ -1009,7 +1098,7 @@ int remote_transport_message_callback::callback(const char* str,int len,void* pa
         static_cast<const void*>(str),
         static_cast<size_t>(len),
         cb->get_payload());
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
 
     if (result == GIT_OK) {
         if (Z_TYPE(retval) != IS_NULL) {
@@ -1037,7 +1126,7 @@ int remote_completion_callback::callback(
     zval_array<2> params;
 
     params.assign<0>(static_cast<long>(type),cb->get_payload());
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
 
     zval_ptr_dtor(&retval);
 
@@ -1109,7 +1198,7 @@ int remote_update_tips_callback::callback(
     convert_oid(params[1],a);
     convert_oid(params[2],b);
     params.assign<3>(cb->get_payload());
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
 
     zval_ptr_dtor(&retval);
 
@@ -1153,7 +1242,7 @@ int remote_push_transfer_progress_callback::callback(
         static_cast<long>(total),
         static_cast<long>(bytes),
         cb->get_payload());
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
 
     zval_ptr_dtor(&retval);
 
@@ -1179,7 +1268,7 @@ int remote_push_update_reference_callback::callback(
         params.assign<1>(status);
     }
     params.assign<2>(cb->get_payload());
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
 
     zval_ptr_dtor(&retval);
 
@@ -1208,7 +1297,7 @@ int remote_push_negotiation_callback::callback(
     }
 
     params.assign<1>(cb->get_payload());
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
 
     zval_ptr_dtor(&retval);
 
@@ -1265,7 +1354,7 @@ int remote_create_callback::callback(
     repoResource.set_object(repo);
     repoResource.ret(params[0]);
     params.assign<1>(name,url,cb->get_payload());
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
 
     if (result == GIT_OK) {
         if (Z_TYPE(retval) == IS_RESOURCE) {
@@ -1337,7 +1426,7 @@ int repository_fetchhead_foreach_callback::callback(
     convert_oid(params[2],oid);
     params.assign<3>(static_cast<bool>(is_merge),cb->get_payload());
 
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
     zval_ptr_dtor(&retval);
 
     return result;
@@ -1358,7 +1447,7 @@ int repository_mergehead_foreach_callback::callback(
     convert_oid(params[0],oid);
     params.assign<1>(cb->get_payload());
 
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
     zval_ptr_dtor(&retval);
 
     return result;
@@ -1381,7 +1470,7 @@ int treebuilder_filter_callback::callback(
     res.ret(params[0]);
     params.assign<1>(cb->get_payload());
 
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
     if (result == GIT_OK) {
         convert_to_boolean(&retval);
         result = ( Z_TYPE(retval) != IS_TRUE );
@@ -1409,7 +1498,7 @@ int submodule_foreach_callback::callback(
     params.assign<1>(name,cb->get_payload());
 
     // Call the userspace callback.
-    result = params.call(cb->get_value(),&retval);
+    result = params.call(cb,&retval);
     zval_ptr_dtor(&retval);
 
     return result;
@@ -10,6 +10,8 @@
 
 namespace php_git2
 {
+    class php_callback_base;
+
     int php_git2_invoke_callback(
         zval* obj,
         zval* func,
@@ -17,6 +19,12 @@ namespace php_git2
         int paramCount,
         zval params[]);
 
+    int php_git2_invoke_callback(
+        php_callback_base* cb,
+        zval* ret,
+        int paramCount,
+        zval params[]);
+
     // Provide a type that contains an array of zvals converted from primative
     // values.
 
@@ -130,6 +138,11 @@ namespace php_git2
             return php_git2_invoke_callback(obj,func,ret,Count,params);
         }
 
+        int call(php_callback_base* cb,zval* ret)
+        {
+            return php_git2_invoke_callback(cb,ret,Count,params);
+        }
+
         void make_ref(unsigned index)
         {
             ZVAL_MAKE_REF(&params[index]);
@@ -186,11 +199,23 @@ namespace php_git2
             parse_with_context(zvpPayload,"payload");
         }
 
+        // Gets the function call cache resolved when the callable was
+        // parsed. The cache is empty (i.e. has no function handler) if the
+        // callable was not resolved or cannot be cached.
+        zend_fcall_info_cache* get_fcall_cache()
+        {
+            return &fcc;
+        }
+
     protected:
         virtual void parse_impl(zval* zvp,int argno);
 
         // NOTE: Callable is stored in 'value' member from base class.
         zval data; // payload
+
+        // The resolved callable. This avoids resolving the callable on every
+        // invocation.
+        zend_fcall_info_cache fcc;
     };
 
     using php_callback_sync = php_callback_base;
@@ -523,15 +548,40 @@ namespace php_git2
     struct git_diff_callback_info
     {
         git_diff_callback_info(zval* zvp):
-            zpayload(zvp)
+            zpayload(zvp), lastDelta(nullptr), lastHunk(nullptr)
+        {
+            ZVAL_UNDEF(&zdelta);
+            ZVAL_UNDEF(&zhunk);
+        }
+
+        ~git_diff_callback_info()
         {
+            zval_ptr_dtor(&zdelta);
+            zval_ptr_dtor(&zhunk);
         }
 
+        // Gets the converted delta/hunk arrays. libgit2 passes the same delta
+        // and hunk to every hunk/line callback for a file, so the last
+        // conversion is memoized and the same (refcounted) array is handed to
+        // userspace. The cached array is reused only if both the pointer and
+        // the structure contents match.
+        zval* get_delta(const git_diff_delta* delta);
+        zval* get_hunk(const git_diff_hunk* hunk);
+
         php_callback_sync* fileCallback;
         php_callback_sync* binaryCallback;
         php_callback_sync* hunkCallback;
         php_callback_sync* lineCallback;
         zval* zpayload;
+
+    private:
+        const git_diff_delta* lastDelta;
+        git_diff_delta deltaCopy;
+        zval zdelta;
+
+        const git_diff_hunk* lastHunk;
+        git_diff_hunk hunkCopy;
+        zval zhunk;
     };
 
     struct diff_file_callback
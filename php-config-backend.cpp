@@ -9,6 +9,7 @@
 
 #include "php-object.h"
 #include <new>
+#include <cctype>
 using namespace php_git2;
 
 // Custom class handlers
@@ -42,9 +43,67 @@ static void custom_backend_entry_free(git_config_entry* ent)
     efree(ent);
 }
 
-static int set_custom_backend_entry(zval* arr,git_config_entry* ent,const char** err)
+static void assign_custom_backend_entry(git_config_entry* ent,
+    const char* name,
+    size_t nameLength,
+    const char* value,
+    size_t valueLength,
+    git_config_level_t level)
 {
     char* buffer;
+
+    // Copy name and length into buffer and assign sections to fields.
+    buffer = (char*)emalloc(nameLength + valueLength + 2);
+    ent->name = buffer;
+    ent->value = buffer + nameLength + 1;
+    memcpy(buffer,name,nameLength);
+    buffer[nameLength] = 0;
+    memcpy(buffer + nameLength + 1,value,valueLength);
+    buffer[nameLength + valueLength + 1] = 0;
+
+    ent->level = level;
+    ent->free = custom_backend_entry_free;
+    ent->payload = buffer;
+}
+
+static git_config_entry* make_cached_backend_entry(const php_config_backend_cache::entry& cached)
+{
+    git_config_entry* ent;
+
+    ent = (git_config_entry*)emalloc(sizeof(git_config_entry));
+    memset(ent,0,sizeof(git_config_entry));
+
+    assign_custom_backend_entry(ent,
+        cached.name.data(),
+        cached.name.length(),
+        cached.value.data(),
+        cached.value.length(),
+        cached.level);
+
+    return ent;
+}
+
+// Normalizes a config entry name the way git2 does before looking up a key:
+// the section and variable names are case-insensitive while the subsection is
+// not.
+
+static std::string normalize_config_name(const char* name)
+{
+    std::string result(name);
+    size_t first = result.find('.');
+    size_t last = result.rfind('.');
+
+    for (size_t i = 0;i < result.length();++i) {
+        if (first == std::string::npos || i < first || i > last) {
+            result[i] = tolower(static_cast<unsigned char>(result[i]));
+        }
+    }
+
+    return result;
+}
+
+static int set_custom_backend_entry(zval* arr,git_config_entry* ent,const char** err)
+{
     zval* zname;
     zval* zvalue;
     zval* zlevel;
@@ -95,16 +154,12 @@ static int set_custom_backend_entry(zval* arr,git_config_entry* ent,const char**
         value = Z_STR_P(zvalue);
     }
 
-    // Copy name and length into buffer and assign sections to fields.
-    buffer = (char*)emalloc(ZSTR_LEN(name) + ZSTR_LEN(value) + 2);
-    ent->name = buffer;
-    ent->value = buffer + ZSTR_LEN(name) + 1;
-    memcpy(buffer,ZSTR_VAL(name),ZSTR_LEN(name)+1);
-    memcpy(buffer + ZSTR_LEN(name) + 1,ZSTR_VAL(value),ZSTR_LEN(value)+1);
-
-    ent->level = level;
-    ent->free = custom_backend_entry_free;
-    ent->payload = buffer;
+    assign_custom_backend_entry(ent,
+        ZSTR_VAL(name),
+        ZSTR_LEN(name),
+        ZSTR_VAL(value),
+        ZSTR_LEN(value),
+        level);
 
     if (sname != nullptr) {
         zend_string_release(sname);
@@ -198,6 +253,92 @@ static int custom_backend_iterator_next(git_config_entry** out,custom_backend_it
     return result;
 }
 
+// Iterates the entries held by a php_config_backend_cache. The iterator keeps
+// its own reference to the entries, so it remains valid when the cache is
+// invalidated during iteration.
+
+struct cached_backend_iterator : git_config_iterator
+{
+    std::shared_ptr<const php_config_backend_cache::entry_list> entries;
+    size_t pos;
+};
+
+static void cached_backend_iterator_free(cached_backend_iterator* iter)
+{
+    iter->~cached_backend_iterator();
+    efree(iter);
+}
+
+static int cached_backend_iterator_next(git_config_entry** out,cached_backend_iterator* iter)
+{
+    if (iter->pos >= iter->entries->size()) {
+        return GIT_ITEROVER;
+    }
+
+    *out = make_cached_backend_entry((*iter->entries)[iter->pos++]);
+
+    return GIT_OK;
+}
+
+// Implementation of php_config_backend_cache
+
+php_config_backend_cache::php_config_backend_cache():
+    isEnabled(false), loads(0), hits(0), misses(0)
+{
+}
+
+const php_config_backend_cache::entry* php_config_backend_cache::find(const char* name)
+{
+    // NOTE: git2 normalizes the key before calling the backend.
+
+    auto iter = lookup.find(name);
+    if (iter == lookup.end()) {
+        misses += 1;
+        return nullptr;
+    }
+
+    hits += 1;
+    return &(*entries)[iter->second];
+}
+
+void php_config_backend_cache::assign(std::shared_ptr<const entry_list> newEntries)
+{
+    entries = std::move(newEntries);
+    lookup.clear();
+    loads += 1;
+
+    // Later entries of a multivar replace earlier ones so that a lookup finds
+    // the last value like the git2 file backend does.
+    for (size_t i = 0;i < entries->size();++i) {
+        lookup[normalize_config_name((*entries)[i].name.c_str())] = i;
+    }
+}
+
+void php_config_backend_cache::invalidate()
+{
+    entries.reset();
+    lookup.clear();
+}
+
+void php_config_backend_cache::set_enabled(bool enable)
+{
+    isEnabled = enable;
+    if (!isEnabled) {
+        invalidate();
+    }
+}
+
+void php_config_backend_cache::get_stats(zval* zv) const
+{
+    array_init_size(zv,5);
+    add_assoc_bool_ex(zv,"enabled",sizeof("enabled")-1,isEnabled);
+    add_assoc_long_ex(zv,"entries",sizeof("entries")-1,
+        entries != nullptr ? static_cast<zend_long>(entries->size()) : 0);
+    add_assoc_long_ex(zv,"loads",sizeof("loads")-1,static_cast<zend_long>(loads));
+    add_assoc_long_ex(zv,"hits",sizeof("hits")-1,static_cast<zend_long>(hits));
+    add_assoc_long_ex(zv,"misses",sizeof("misses")-1,static_cast<zend_long>(misses));
+}
+
 // Class method entries
 
 zend_function_entry php_git2::config_backend_methods[] = {
@@ -292,6 +433,12 @@ void php_config_backend_object::create_custom_backend(zval* zobj,php_git_config*
 
     result = method.call(params);
 
+    // Load the entries up front so that the lookups performed while opening
+    // a repository do not call into userspace.
+    if (result == GIT_OK && method.backing()->cache.enabled()) {
+        result = load_cache(cfg);
+    }
+
     return result;
 }
 
@@ -301,6 +448,28 @@ void php_config_backend_object::create_custom_backend(zval* zobj,php_git_config*
     git_config_entry** out)
 {
     int result;
+    php_config_backend_cache& cache = method_wrapper::object_wrapper(cfg).backing()->cache;
+
+    if (cache.enabled()) {
+        const php_config_backend_cache::entry* ent;
+
+        if (!cache.loaded()) {
+            result = load_cache(cfg);
+            if (result != GIT_OK) {
+                return result;
+            }
+        }
+
+        ent = cache.find(key);
+        if (ent == nullptr) {
+            return GIT_ENOTFOUND;
+        }
+
+        *out = make_cached_backend_entry(*ent);
+
+        return GIT_OK;
+    }
+
     zval_array<1> params;
     method_wrapper method("get",cfg);
 
@@ -374,6 +543,9 @@ void php_config_backend_object::create_custom_backend(zval* zobj,php_git_config*
 
     result = method.call(params);
 
+    // The entries may have changed, so they are reloaded when next needed.
+    method.backing()->cache.invalidate();
+
     return result;
 }
 
@@ -398,6 +570,9 @@ void php_config_backend_object::create_custom_backend(zval* zobj,php_git_config*
 
     result = method.call(params);
 
+    // The entries may have changed, so they are reloaded when next needed.
+    method.backing()->cache.invalidate();
+
     return result;
 }
 
@@ -416,6 +591,9 @@ void php_config_backend_object::create_custom_backend(zval* zobj,php_git_config*
 
     result = method.call(params);
 
+    // The entries may have changed, so they are reloaded when next needed.
+    method.backing()->cache.invalidate();
+
     return result;
 }
 
@@ -438,12 +616,47 @@ void php_config_backend_object::create_custom_backend(zval* zobj,php_git_config*
 
     result = method.call(params);
 
+    // The entries may have changed, so they are reloaded when next needed.
+    method.backing()->cache.invalidate();
+
     return result;
 }
 
 /*static*/ int php_config_backend_object::iterator(
     git_config_iterator** out,
     git_config_backend* cfg)
+{
+    php_config_backend_cache& cache = method_wrapper::object_wrapper(cfg).backing()->cache;
+
+    if (cache.enabled()) {
+        cached_backend_iterator* iter;
+
+        if (!cache.loaded()) {
+            int result = load_cache(cfg);
+            if (result != GIT_OK) {
+                return result;
+            }
+        }
+
+        iter = new (emalloc(sizeof(cached_backend_iterator))) cached_backend_iterator();
+        iter->backend = cfg;
+        iter->flags = 0;
+        iter->next = (int(*)(git_config_entry**,git_config_iterator*))cached_backend_iterator_next;
+        iter->free = (void(*)(git_config_iterator*))cached_backend_iterator_free;
+        iter->entries = cache.get_entries();
+        iter->pos = 0;
+
+        *out = iter;
+
+        return GIT_OK;
+    }
+
+    return userspace_iterator(out,cfg);
+}
+
+/*static*/ int php_config_backend_object::userspace_iterator(
+    git_config_iterator** out,
+    git_config_backend* cfg)
 {
     int result;
     method_wrapper method("iterator_new",cfg);
@@ -504,6 +717,12 @@ void php_config_backend_object::create_custom_backend(zval* zobj,php_git_config*
         internal->create_custom_backend(obj.get_value(),method.backing()->owner);
         *out = internal->backend;
 
+        // The snapshot is cached like its parent. Its entries are loaded when
+        // git2 opens it.
+        if (method.backing()->cache.enabled()) {
+            internal->cache.set_enabled(true);
+        }
+
     } catch (php_git2_exception_base& ex) {
         const char* msg = ex.what();
         if (msg == nullptr) {
@@ -544,9 +763,43 @@ void php_config_backend_object::create_custom_backend(zval* zobj,php_git_config*
 
     result = method.call(params);
 
+    // The entries may have changed, so they are reloaded when next needed.
+    method.backing()->cache.invalidate();
+
     return result;
 }
 
+/*static*/ int php_config_backend_object::load_cache(git_config_backend* cfg)
+{
+    int result;
+    git_config_iterator* iter;
+    git_config_entry* ent;
+    std::shared_ptr<php_config_backend_cache::entry_list> entries;
+
+    // Make a single pass over the userspace iterator.
+
+    result = userspace_iterator(&iter,cfg);
+    if (result != GIT_OK) {
+        return result;
+    }
+
+    entries = std::make_shared<php_config_backend_cache::entry_list>();
+    while ((result = iter->next(&ent,iter)) == GIT_OK) {
+        entries->push_back(php_config_backend_cache::entry{ent->name,ent->value,ent->level});
+        ent->free(ent);
+    }
+
+    iter->free(iter);
+
+    if (result != GIT_ITEROVER) {
+        return result;
+    }
+
+    method_wrapper::object_wrapper(cfg).backing()->cache.assign(std::move(entries));
+
+    return GIT_OK;
+}
+
 /*static*/ void php_config_backend_object::free(git_config_backend* cfg)
 {
     // Set backend to null in internal storage (just in case). Then explicitly
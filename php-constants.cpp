@@ -20,6 +20,23 @@ using namespace php_git2;
 
 void php_git2::php_git2_register_constants(int module_number)
 {
+    // GIT2_* (extension-specific)
+    PHP_GIT2_CONSTANT(GIT2_DIFF_MATERIALIZE_OFFSETS);
+    PHP_GIT2_CONSTANT(GIT2_OID_HEX);
+    PHP_GIT2_CONSTANT(GIT2_OID_BINARY);
+    PHP_GIT2_CONSTANT(GIT2_COMMIT_INFO_ID);
+    PHP_GIT2_CONSTANT(GIT2_COMMIT_INFO_TREE_ID);
+    PHP_GIT2_CONSTANT(GIT2_COMMIT_INFO_PARENT_IDS);
+    PHP_GIT2_CONSTANT(GIT2_COMMIT_INFO_AUTHOR);
+    PHP_GIT2_CONSTANT(GIT2_COMMIT_INFO_COMMITTER);
+    PHP_GIT2_CONSTANT(GIT2_COMMIT_INFO_MESSAGE);
+    PHP_GIT2_CONSTANT(GIT2_COMMIT_INFO_SUMMARY);
+    PHP_GIT2_CONSTANT(GIT2_COMMIT_INFO_TIME);
+    PHP_GIT2_CONSTANT(GIT2_COMMIT_INFO_ENCODING);
+    PHP_GIT2_CONSTANT(GIT2_COMMIT_INFO_ALL);
+    PHP_GIT2_CONSTANT(GIT2_TREE_LIST_COLUMNAR);
+    PHP_GIT2_CONSTANT(GIT2_TREE_LIST_BLOBS_ONLY);
+
     // GIT_*
     PHP_GIT2_CONSTANT(GIT_ERROR);
     PHP_GIT2_CONSTANT(GIT_ITEROVER);
@@ -241,6 +241,23 @@ namespace php_git2
         };
     };
 
+    // Brackets a call into libgit2 so that writes buffered by custom ODB
+    // backends are flushed before the outermost call returns to PHP.
+
+    class php_git2_write_scope
+    {
+    public:
+        php_git2_write_scope()
+        {
+            php_git2_write_scope_enter();
+        }
+
+        ~php_git2_write_scope()
+        {
+            php_git2_write_scope_leave();
+        }
+    };
+
     // Provide a function that calls a wrapped library function with a local
     // pack.
 
@@ -253,6 +270,8 @@ namespace php_git2
         local_pack<Ts...>& pack,
         sequence<Ns...>&& seq)
     {
+        php_git2_write_scope scope;
+
         return FuncWrapper::name(pack.template get<Ns>().byval_git2()...);
     }
 
@@ -330,9 +349,7 @@ namespace php_git2
     php_return(const git_oid* retval,local_pack<Ts...>& pack,zval* return_value)
     {
         if (retval != nullptr) {
-            char buf[GIT_OID_HEXSZ + 1];
-            git_oid_tostr(buf,sizeof(buf),retval);
-            RETVAL_STRINGL(buf,strlen(buf));
+            php_git2::convert_oid(return_value,retval);
         }
         else {
             RETVAL_NULL();
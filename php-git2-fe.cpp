@@ -50,15 +50,26 @@
 #include "clone.h"
 #include "submodule.h"
 #include "worktree.h"
+#include "graph.h"
+#include "commitgraph.h"
+#include "midx.h"
 
 // Exported extension functions defined in this unit.
 static PHP_FUNCTION(git_libgit2_version);
 static PHP_FUNCTION(git2_version);
+static PHP_FUNCTION(git2_opts_set);
+static PHP_FUNCTION(git2_opts_get);
+static PHP_FUNCTION(git2_set_oid_format);
+static PHP_FUNCTION(git2_resource_stats);
 
 // Functions exported by this extension into PHP.
 zend_function_entry php_git2::functions[] = {
     // Functions that do not directly wrap libgit2 exports:
     PHP_FE(git2_version,NULL)
+    PHP_FE(git2_opts_set,NULL)
+    PHP_FE(git2_opts_get,NULL)
+    PHP_FE(git2_set_oid_format,NULL)
+    PHP_FE(git2_resource_stats,NULL)
 
     // General libgit2 functions:
     PHP_FE(git_libgit2_version,NULL)
@@ -119,6 +130,9 @@ zend_function_entry php_git2::functions[] = {
     GIT_CLONE_FE
     GIT_SUBMODULE_FE
     GIT_WORKTREE_FE
+    GIT_GRAPH_FE
+    GIT_COMMITGRAPH_FE
+    GIT_MIDX_FE
     PHP_FE_END
 };
 
@@ -167,3 +181,101 @@ PHP_FUNCTION(git2_version)
 
     RETURN_STRING(buf);
 }
+
+PHP_FUNCTION(git2_opts_set)
+{
+    php_git2::php_bailer bailer;
+
+    {
+        php_git2::php_bailout_context ctx(bailer);
+
+        if (BAILOUT_ENTER_REGION(ctx)) {
+            char* name;
+            size_t namelen;
+            zval* zvp;
+            if (zend_parse_parameters(ZEND_NUM_ARGS(),"sz",&name,&namelen,&zvp) == FAILURE) {
+                return;
+            }
+
+            try {
+                php_git2::php_git2_opts_set(name,namelen,zvp);
+
+            } catch (php_git2::php_git2_exception_base& ex) {
+                php_git2::php_bailout_context ctx2(bailer);
+
+                if (BAILOUT_ENTER_REGION(ctx2)) {
+                    ex.handle();
+                }
+            }
+        }
+    }
+}
+
+PHP_FUNCTION(git2_opts_get)
+{
+    php_git2::php_bailer bailer;
+
+    {
+        php_git2::php_bailout_context ctx(bailer);
+
+        if (BAILOUT_ENTER_REGION(ctx)) {
+            char* name = nullptr;
+            size_t namelen = 0;
+            if (zend_parse_parameters(ZEND_NUM_ARGS(),"|s!",&name,&namelen) == FAILURE) {
+                return;
+            }
+
+            try {
+                php_git2::php_git2_opts_get(return_value,name,namelen);
+
+            } catch (php_git2::php_git2_exception_base& ex) {
+                php_git2::php_bailout_context ctx2(bailer);
+
+                if (BAILOUT_ENTER_REGION(ctx2)) {
+                    ex.handle();
+                }
+            }
+        }
+    }
+}
+
+PHP_FUNCTION(git2_set_oid_format)
+{
+    zend_long format;
+    zend_string* name;
+    const char* value;
+    zend_long previous = GIT2_G(oidFormat);
+
+    if (zend_parse_parameters(ZEND_NUM_ARGS(),"l",&format) == FAILURE) {
+        return;
+    }
+
+    if (format == GIT2_OID_HEX) {
+        value = "hex";
+    }
+    else if (format == GIT2_OID_BINARY) {
+        value = "binary";
+    }
+    else {
+        zend_throw_exception(php_git2::exception_ce,"Invalid OID format",0);
+        return;
+    }
+
+    // Change the setting via the INI entry so that it is restored at the end
+    // of the request.
+
+    name = zend_string_init("git2.oid_format",sizeof("git2.oid_format")-1,0);
+    zend_alter_ini_entry_chars(name,value,strlen(value),PHP_INI_USER,PHP_INI_STAGE_RUNTIME);
+    zend_string_release(name);
+
+    RETURN_LONG(previous);
+}
+
+PHP_FUNCTION(git2_resource_stats)
+{
+    if (zend_parse_parameters_none() == FAILURE) {
+        return;
+    }
+
+    php_git2::git2_resource_pool::get_stats(return_value);
+}
@@ -46,8 +46,45 @@ zend_module_entry git2_module_entry = {
 ZEND_GET_MODULE(git2)
 #endif
 
+// Handle updates to git2.oid_format.
+static ZEND_INI_MH(OnUpdateOidFormat)
+{
+    if (ZSTR_LEN(new_value) == 0 || strcasecmp(ZSTR_VAL(new_value),"hex") == 0) {
+        GIT2_G(oidFormat) = GIT2_OID_HEX;
+    }
+    else if (strcasecmp(ZSTR_VAL(new_value),"binary") == 0) {
+        GIT2_G(oidFormat) = GIT2_OID_BINARY;
+    }
+    else {
+        return FAILURE;
+    }
+
+    return SUCCESS;
+}
+
 // Create php.ini settings.
 PHP_INI_BEGIN()
+    STD_PHP_INI_ENTRY("git2.persistent_repos","0",PHP_INI_SYSTEM,OnUpdateLong,
+        persistentReposMax,zend_git2_globals,git2_globals)
+    STD_PHP_INI_ENTRY("git2.persistent_repos_ttl","0",PHP_INI_SYSTEM,OnUpdateLong,
+        persistentReposTTL,zend_git2_globals,git2_globals)
+    PHP_INI_ENTRY("git2.oid_format","hex",PHP_INI_ALL,OnUpdateOidFormat)
+#ifdef HAVE_GIT2_SQLITE
+    STD_PHP_INI_ENTRY("git2.sqlite_busy_timeout","5000",PHP_INI_ALL,OnUpdateLong,
+        sqliteBusyTimeout,zend_git2_globals,git2_globals)
+#endif
+    PHP_INI_ENTRY("git2.mwindow_size","",PHP_INI_SYSTEM,nullptr)
+    PHP_INI_ENTRY("git2.mwindow_mapped_limit","",PHP_INI_SYSTEM,nullptr)
+    PHP_INI_ENTRY("git2.mwindow_file_limit","",PHP_INI_SYSTEM,nullptr)
+    PHP_INI_ENTRY("git2.cache_max_size","",PHP_INI_SYSTEM,nullptr)
+    PHP_INI_ENTRY("git2.enable_caching","",PHP_INI_SYSTEM,nullptr)
+    PHP_INI_ENTRY("git2.cache_object_limit_commit","",PHP_INI_SYSTEM,nullptr)
+    PHP_INI_ENTRY("git2.cache_object_limit_tree","",PHP_INI_SYSTEM,nullptr)
+    PHP_INI_ENTRY("git2.cache_object_limit_blob","",PHP_INI_SYSTEM,nullptr)
+    PHP_INI_ENTRY("git2.cache_object_limit_tag","",PHP_INI_SYSTEM,nullptr)
+    PHP_INI_ENTRY("git2.strict_hash_verification","",PHP_INI_SYSTEM,nullptr)
+    PHP_INI_ENTRY("git2.strict_object_creation","",PHP_INI_SYSTEM,nullptr)
+    PHP_INI_ENTRY("git2.pack_max_objects","",PHP_INI_SYSTEM,nullptr)
 PHP_INI_END()
 
 // Implementation of internal functions.
@@ -65,6 +102,11 @@ PHP_MINIT_FUNCTION(git2)
     php_git2_globals_init();
     REGISTER_INI_ENTRIES();
 
+    // Apply global libgit2 options configured in php.ini.
+    git_libgit2_init();
+    php_git2_opts_init();
+    git_libgit2_shutdown();
+
     // Call the function to register all resource types. Whenever a resource
     // type is added, the libgit2 data type name should be added to the list of
     // template parameters.
@@ -74,6 +116,8 @@ PHP_MINIT_FUNCTION(git2)
         git_blob,
         git_branch_iterator,
         git_commit,
+        git_commit_graph,
+        git_commit_graph_writer,
         git_config,
         git_config_iterator,
         git_cred,
@@ -83,6 +127,7 @@ PHP_MINIT_FUNCTION(git2)
         git_index,
         git_index_conflict_iterator,
         git_indexer,
+        git_midx_writer,
         git_note,
         git_note_iterator,
         git_object,
@@ -115,6 +160,12 @@ PHP_MINIT_FUNCTION(git2)
     // Register all libgit2 constants.
     php_git2_register_constants(module_number);
 
+    // Create array templates used when converting libgit2 structures.
+    php_git2_convert_init();
+
+    // Register the git2:// stream wrapper.
+    php_git2_register_stream_wrapper();
+
     // Register a custom exception type that will be thrown by the extension.
     //  class Git2Exception extends RuntimeException
     zend_class_entry ce;
@@ -126,6 +177,9 @@ PHP_MINIT_FUNCTION(git2)
 
 PHP_MSHUTDOWN_FUNCTION(git2)
 {
+    php_git2_unregister_stream_wrapper();
+    php_git2_convert_shutdown();
+
 #ifndef ZTS
     php_git2_globals_dtor(&git2_globals);
 #endif
@@ -145,6 +199,16 @@ PHP_MINFO_FUNCTION(git2)
     php_info_print_table_row(2,PHP_GIT2_EXTNAME,"enabled");
     php_info_print_table_row(2,"extension version",PHP_GIT2_EXTVER);
     php_info_print_table_row(2,"libgit2 version",buf);
+#ifdef HAVE_GIT2_SQLITE
+    php_info_print_table_row(2,"SQLite ODB backend","enabled");
+#else
+    php_info_print_table_row(2,"SQLite ODB backend","disabled");
+#endif
+    if (GIT2_G(persistentRepos) != nullptr) {
+        snprintf(buf,sizeof(buf),"%u",zend_hash_num_elements(GIT2_G(persistentRepos)));
+        php_info_print_table_row(2,"persistent repositories",buf);
+    }
+    php_git2_opts_info();
     php_info_print_table_end();
 
     DISPLAY_INI_ENTRIES();
@@ -157,6 +221,9 @@ PHP_RINIT_FUNCTION(git2)
     // Initialize git2 library.
     git_libgit2_init();
 
+    // Revert global libgit2 options changed by a previous request.
+    php_git2_opts_request_init();
+
     return SUCCESS;
 }
 
@@ -169,9 +236,17 @@ PHP_RSHUTDOWN_FUNCTION(git2)
 
 int php_git2_post_deactivate()
 {
+    // Trim the persistent repository pool now that the request's resources
+    // have been destroyed.
+    php_git2_persistent_repository_trim();
+
+    // Release the slabs used to allocate resource objects during the request.
+    git2_resource_pool::reset_all();
+
     // Deinitialize libgit2. At this point, all resources should have been
     // freed. This means they would call their destructors and all libgit2
-    // memory should be freed.
+    // memory should be freed. (Any persistent repositories hold their own
+    // library reference, so libgit2 stays initialized for them.)
     git_libgit2_shutdown();
 
     return SUCCESS;
@@ -342,11 +417,27 @@ void php_git2::php_git2_giterr_set(int errorClass,const char* format, ...)
 void php_git2::php_git2_globals_ctor(zend_git2_globals* gbls)
 {
     gbls->propagateError = false;
+    gbls->persistentReposMax = 0;
+    gbls->persistentReposTTL = 0;
+    gbls->persistentRepos = nullptr;
+    gbls->oidFormat = GIT2_OID_HEX;
+    gbls->writeScopeDepth = 0;
+    gbls->writeScopeEntries = nullptr;
+    gbls->writeScopeCount = 0;
+    gbls->writeScopeCapacity = 0;
+#ifdef HAVE_GIT2_SQLITE
+    gbls->sqliteBusyTimeout = 5000;
+#endif
 }
 
 void php_git2::php_git2_globals_dtor(zend_git2_globals* gbls)
 {
-    UNUSED(gbls);
+    php_git2_persistent_repository_destroy(gbls);
+
+    if (gbls->writeScopeEntries != nullptr) {
+        pefree(gbls->writeScopeEntries,1);
+        gbls->writeScopeEntries = nullptr;
+    }
 }
 
 void php_git2::php_git2_globals_init()
@@ -365,6 +456,10 @@ void php_git2::php_git2_globals_request_init()
 {
     GIT2_G(propagateError) = false;
     GIT2_G(requestActive) = true;
+
+    // Forget callbacks left deferred by a request that bailed out.
+    GIT2_G(writeScopeDepth) = 0;
+    GIT2_G(writeScopeCount) = 0;
 }
 
 void php_git2::php_git2_globals_request_shutdown()
@@ -377,32 +472,503 @@ void php_git2::php_git2_globals_request_shutdown()
     GIT2_G(requestActive) = false;
 }
 
+// Write scope functions
+
+void php_git2::php_git2_write_scope_enter()
+{
+    GIT2_G(writeScopeDepth) += 1;
+}
+
+void php_git2::php_git2_write_scope_leave()
+{
+    // Run deferred callbacks while the depth is still nonzero so that calls
+    // into libgit2 made by the callbacks do not flush recursively.
+
+    if (GIT2_G(writeScopeDepth) == 1) {
+        while (GIT2_G(writeScopeCount) > 0) {
+            php_git2_write_scope_entry entry;
+            int result;
+
+            GIT2_G(writeScopeCount) -= 1;
+            entry = GIT2_G(writeScopeEntries)[GIT2_G(writeScopeCount)];
+            result = entry.callback(entry.payload);
+
+            // Report failures that did not already raise a PHP exception.
+            if (result < 0 && EG(exception) == nullptr) {
+                try {
+                    php_git2::git_error(result);
+                } catch (php_git2_exception_base& ex) {
+                    ex.handle();
+                }
+            }
+        }
+    }
+
+    GIT2_G(writeScopeDepth) -= 1;
+}
+
+bool php_git2::php_git2_write_scope_active()
+{
+    return GIT2_G(writeScopeDepth) > 0;
+}
+
+void php_git2::php_git2_write_scope_defer(php_git2_write_scope_callback callback,void* payload)
+{
+    php_git2_write_scope_entry* entries = GIT2_G(writeScopeEntries);
+    size_t count = GIT2_G(writeScopeCount);
+
+    for (size_t i = 0;i < count;++i) {
+        if (entries[i].payload == payload) {
+            return;
+        }
+    }
+
+    // The entries are persistent since the array is reused by each request.
+
+    if (count == GIT2_G(writeScopeCapacity)) {
+        size_t capacity = (count == 0) ? 8 : count * 2;
+
+        entries = reinterpret_cast<php_git2_write_scope_entry*>(
+            perealloc(entries,capacity * sizeof(php_git2_write_scope_entry),1));
+        GIT2_G(writeScopeEntries) = entries;
+        GIT2_G(writeScopeCapacity) = capacity;
+    }
+
+    entries[count].callback = callback;
+    entries[count].payload = payload;
+    GIT2_G(writeScopeCount) = count + 1;
+}
+
+void php_git2::php_git2_write_scope_cancel(void* payload)
+{
+    php_git2_write_scope_entry* entries = GIT2_G(writeScopeEntries);
+    size_t count = GIT2_G(writeScopeCount);
+    size_t n = 0;
+
+    for (size_t i = 0;i < count;++i) {
+        if (entries[i].payload != payload) {
+            entries[n++] = entries[i];
+        }
+    }
+
+    GIT2_G(writeScopeCount) = n;
+}
+
+// Array templates
+
+// Each converted libgit2 structure with a fixed set of keys has a prebuilt
+// template array created at MINIT. The template keys are permanent interned
+// strings so they never have to be hashed or allocated again. A conversion
+// duplicates the template (one sized allocation) and then writes the values
+// directly into the buckets in key order.
+
+enum array_template_kind
+{
+    TEMPLATE_TRANSFER_PROGRESS,
+    TEMPLATE_BLAME_HUNK,
+    TEMPLATE_DIFF_DELTA,
+    TEMPLATE_DIFF_FILE,
+    TEMPLATE_DIFF_BINARY,
+    TEMPLATE_DIFF_BINARY_FILE,
+    TEMPLATE_DIFF_HUNK,
+    TEMPLATE_DIFF_LINE,
+    TEMPLATE_DIFF_PERFDATA,
+    TEMPLATE_SIGNATURE,
+    TEMPLATE_INDEX_ENTRY,
+    TEMPLATE_INDEX_TIME,
+    TEMPLATE_MERGE_FILE_RESULT,
+    TEMPLATE_REFLOG_ENTRY,
+    TEMPLATE_REBASE_OPERATION,
+    TEMPLATE_CERT,
+    TEMPLATE_PUSH_UPDATE,
+    TEMPLATE_REMOTE_HEAD,
+    TEMPLATE_TREE_LIST_ENTRY,
+    _TEMPLATE_COUNT
+};
+
+// NOTE: The order of the keys for each template must match the order in which
+// the corresponding convert_* function writes its values.
+
+static const char* const TEMPLATE_KEYS[_TEMPLATE_COUNT][20] = {
+    // TEMPLATE_TRANSFER_PROGRESS
+    {
+        "total_objects", "indexed_objects", "received_objects", "local_objects",
+        "total_deltas", "indexed_deltas", "received_bytes", nullptr
+    },
+    // TEMPLATE_BLAME_HUNK
+    {
+        "lines_in_hunk", "final_commit_id", "final_start_line_number",
+        "final_signature.name", "final_signature.email",
+        "final_signature.when.time", "final_signature.when.offset",
+        "orig_commit_id", "orig_path", "orig_start_line_number",
+        "orig_signature.name", "orig_signature.email",
+        "orig_signature.when.time", "orig_signature.when.offset",
+        "boundary", nullptr
+    },
+    // TEMPLATE_DIFF_DELTA
+    {
+        "status", "flags", "similarity", "nfiles", "old_file", "new_file", nullptr
+    },
+    // TEMPLATE_DIFF_FILE
+    {
+        "id", "path", "size", "flags", "mode", nullptr
+    },
+    // TEMPLATE_DIFF_BINARY
+    {
+        "contains_data", "old_file", "new_file", nullptr
+    },
+    // TEMPLATE_DIFF_BINARY_FILE
+    {
+        "type", "data", "inflatedlen", nullptr
+    },
+    // TEMPLATE_DIFF_HUNK
+    {
+        "old_start", "old_lines", "new_start", "new_lines", "header", nullptr
+    },
+    // TEMPLATE_DIFF_LINE
+    {
+        "origin", "old_lineno", "new_lineno", "num_lines", "content_offset",
+        "content", nullptr
+    },
+    // TEMPLATE_DIFF_PERFDATA
+    {
+        "stat_calls", "oid_calculations", nullptr
+    },
+    // TEMPLATE_SIGNATURE
+    {
+        "name", "email", "when.time", "when.offset", nullptr
+    },
+    // TEMPLATE_INDEX_ENTRY
+    {
+        "ctime", "mtime", "dev", "ino", "mode", "uid", "gid", "file_size", "id",
+        "flags", "flags_extended", "path", nullptr
+    },
+    // TEMPLATE_INDEX_TIME
+    {
+        "seconds", "nanoseconds", nullptr
+    },
+    // TEMPLATE_MERGE_FILE_RESULT
+    {
+        "automergeable", "path", "mode", "ptr", nullptr
+    },
+    // TEMPLATE_REFLOG_ENTRY
+    {
+        "committer", "id_new", "id_old", "message", nullptr
+    },
+    // TEMPLATE_REBASE_OPERATION
+    {
+        "type", "id", "exec", nullptr
+    },
+    // TEMPLATE_CERT
+    {
+        "cert_type", nullptr
+    },
+    // TEMPLATE_PUSH_UPDATE
+    {
+        "src_refname", "dst_refname", "src", "dst", nullptr
+    },
+    // TEMPLATE_REMOTE_HEAD
+    {
+        "local", "oid", "loid", "name", "symref_target", nullptr
+    },
+    // TEMPLATE_TREE_LIST_ENTRY
+    {
+        "path", "mode", "type", "id", nullptr
+    },
+};
+
+// ZTS builds prior to PHP 7.3 cannot intern strings at startup. A key shared
+// between threads would then have its refcount modified concurrently, so those
+// builds create each array (and its keys) the ordinary way instead.
+#if PHP_VERSION_ID >= 70300 || !defined(ZTS)
+#define GIT2_PERMANENT_KEYS
+#endif
+
+static HashTable* templates[_TEMPLATE_COUNT];
+
+// Keys for arrays whose set of keys varies.
+static zend_string* keyStatus;
+static zend_string* keyHeadToIndex;
+static zend_string* keyIndexToWorkdir;
+
+// Keys for commit info arrays. These are indexed by the bit position of the
+// corresponding GIT2_COMMIT_INFO_* flag (with an extra key for the time
+// offset).
+enum commit_info_key
+{
+    COMMIT_KEY_ID,
+    COMMIT_KEY_TREE_ID,
+    COMMIT_KEY_PARENT_IDS,
+    COMMIT_KEY_AUTHOR,
+    COMMIT_KEY_COMMITTER,
+    COMMIT_KEY_MESSAGE,
+    COMMIT_KEY_SUMMARY,
+    COMMIT_KEY_TIME,
+    COMMIT_KEY_MESSAGE_ENCODING,
+    COMMIT_KEY_TIME_OFFSET,
+    _COMMIT_KEY_COUNT
+};
+
+static const char* const COMMIT_INFO_KEYS[] = {
+    "id", "tree_id", "parent_ids", "author", "committer", "message", "summary",
+    "time", "message_encoding", "time_offset"
+};
+
+static zend_string* commitInfoKeys[_COMMIT_KEY_COUNT];
+
+static zend_string* make_permanent_key(const char* key)
+{
+#if PHP_VERSION_ID >= 70300
+    return zend_string_init_interned(key,strlen(key),1);
+#elif defined(GIT2_PERMANENT_KEYS)
+    zend_string* str = zend_string_init(key,strlen(key),1);
+    return zend_new_interned_string(str);
+#else
+    // The key is only read (never added to an array) on this configuration.
+    zend_string* str = zend_string_init(key,strlen(key),1);
+    zend_string_hash_val(str);
+    return str;
+#endif
+}
+
+// Adds a value to an array under a key created by make_permanent_key().
+
+static inline void add_permanent_key(HashTable* ht,zend_string* key,zval* zv)
+{
+#ifdef GIT2_PERMANENT_KEYS
+    zend_hash_add_new(ht,key,zv);
+#else
+    zend_hash_str_add_new(ht,ZSTR_VAL(key),ZSTR_LEN(key),zv);
+#endif
+}
+
+// Provide a type that writes values into an array created from a template.
+
+class array_template_writer
+{
+public:
+#ifdef GIT2_PERMANENT_KEYS
+    array_template_writer(zval* zv,array_template_kind kind)
+    {
+        ZVAL_ARR(zv,zend_array_dup(templates[kind]));
+        bucket = Z_ARRVAL_P(zv)->arData;
+    }
+#else
+    array_template_writer(zval* zv,array_template_kind kind):
+        keys(TEMPLATE_KEYS[kind])
+    {
+        uint32_t n = 0;
+
+        while (keys[n] != nullptr) {
+            n += 1;
+        }
+
+        array_init_size(zv,n);
+        ht = Z_ARRVAL_P(zv);
+    }
+#endif
+
+    void put_long(zend_long value)
+    {
+        ZVAL_LONG(next(),value);
+    }
+
+    void put_bool(bool value)
+    {
+        ZVAL_BOOL(next(),value);
+    }
+
+    void put_null()
+    {
+        next();
+    }
+
+    void put_string(const char* str)
+    {
+        zval* zv = next();
+
+        if (str != nullptr) {
+            ZVAL_STRING(zv,str);
+        }
+    }
+
+    void put_stringl(const char* str,size_t len)
+    {
+        ZVAL_STRINGL(next(),str,len);
+    }
+
+    void put_str(zend_string* str)
+    {
+        ZVAL_STR_COPY(next(),str);
+    }
+
+    void put_oid(const git_oid* oid)
+    {
+        convert_oid(next(),oid);
+    }
+
+    // Returns the value slot so that a nested value may be converted in place.
+    zval* put_zval()
+    {
+        return next();
+    }
+
+private:
+    // Returns the slot for the next key. The slot holds null.
+    zval* next()
+    {
+#ifdef GIT2_PERMANENT_KEYS
+        return &(bucket++)->val;
+#else
+        const char* key = *keys++;
+        zval znull;
+
+        ZVAL_NULL(&znull);
+        return zend_hash_str_add_new(ht,key,strlen(key),&znull);
+#endif
+    }
+
+#ifdef GIT2_PERMANENT_KEYS
+    Bucket* bucket;
+#else
+    const char* const* keys;
+    HashTable* ht;
+#endif
+};
+
+// Table of two-character hex strings for each byte value. This lets the hex
+// encoder emit an OID with 20 small copies instead of 40 nibble lookups.
+static char hexPairs[512];
+
+void php_git2::php_git2_convert_init()
+{
+    static const char digits[] = "0123456789abcdef";
+
+    for (int i = 0;i < 256;++i) {
+        hexPairs[i * 2] = digits[i >> 4];
+        hexPairs[i * 2 + 1] = digits[i & 0x0f];
+    }
+
+#ifdef GIT2_PERMANENT_KEYS
+    for (int i = 0;i < _TEMPLATE_COUNT;++i) {
+        HashTable* ht;
+        uint32_t n = 0;
+        zval znull;
+
+        while (TEMPLATE_KEYS[i][n] != nullptr) {
+            n += 1;
+        }
+
+        ht = reinterpret_cast<HashTable*>(pemalloc(sizeof(HashTable),1));
+        zend_hash_init(ht,n,nullptr,nullptr,1);
+
+        ZVAL_NULL(&znull);
+        for (uint32_t j = 0;j < n;++j) {
+            zend_hash_add_new(ht,make_permanent_key(TEMPLATE_KEYS[i][j]),&znull);
+        }
+
+        templates[i] = ht;
+    }
+#endif
+
+    keyStatus = make_permanent_key("status");
+    keyHeadToIndex = make_permanent_key("head_to_index");
+    keyIndexToWorkdir = make_permanent_key("index_to_workdir");
+
+    for (int i = 0;i < _COMMIT_KEY_COUNT;++i) {
+        commitInfoKeys[i] = make_permanent_key(COMMIT_INFO_KEYS[i]);
+    }
+}
+
+void php_git2::php_git2_convert_shutdown()
+{
+    for (int i = 0;i < _TEMPLATE_COUNT;++i) {
+        if (templates[i] != nullptr) {
+            zend_hash_destroy(templates[i]);
+            pefree(templates[i],1);
+            templates[i] = nullptr;
+        }
+    }
+
+#ifndef GIT2_PERMANENT_KEYS
+    zend_string_release(keyStatus);
+    zend_string_release(keyHeadToIndex);
+    zend_string_release(keyIndexToWorkdir);
+
+    for (int i = 0;i < _COMMIT_KEY_COUNT;++i) {
+        zend_string_release(commitInfoKeys[i]);
+    }
+#endif
+}
+
 // Helpers
 
-int php_git2::convert_oid_fromstr(git_oid* dest,const char* src,size_t srclen)
+static void oid_fmt_hex(char* out,const git_oid* oid)
+{
+    for (int i = 0;i < GIT_OID_RAWSZ;++i) {
+        memcpy(out + i * 2,hexPairs + oid->id[i] * 2,2);
+    }
+}
+
+static int oid_parse_hex(git_oid* dest,const char* src,size_t srclen)
 {
-    // Use a temporary buffer to hold the OID hex string. We make sure it can at
-    // most contain a 40 character string. A prefix OID string may have less
-    // than 40 characters.
+    // Full-length OID strings are parsed in place. Use a temporary buffer to
+    // hold a prefix OID string (i.e. less than 40 characters) so that it can
+    // be padded out with zeros.
 
     char buf[GIT_OID_HEXSZ + 1];
 
-    if (srclen > GIT_OID_HEXSZ) {
-        srclen = GIT_OID_HEXSZ;
+    if (srclen >= GIT_OID_HEXSZ) {
+        return git_oid_fromstrn(dest,src,GIT_OID_HEXSZ);
     }
 
     memset(buf,'0',GIT_OID_HEXSZ);
     buf[GIT_OID_HEXSZ] = 0;
-    strncpy(buf,src,srclen);
+    memcpy(buf,src,srclen);
 
     return git_oid_fromstr(dest,buf);
 }
 
+int php_git2::convert_oid_fromstr(git_oid* dest,const char* src,size_t srclen)
+{
+    if (srclen == GIT_OID_RAWSZ && php_git2_oid_binary()) {
+        git_oid_fromraw(dest,reinterpret_cast<const unsigned char*>(src));
+        return 0;
+    }
+
+    return oid_parse_hex(dest,src,srclen);
+}
+
+int php_git2::convert_oid_fromhex(git_oid* dest,const char* src,size_t srclen)
+{
+    return oid_parse_hex(dest,src,srclen);
+}
+
+size_t php_git2::convert_oid_buffer(char* buf,const git_oid* oid)
+{
+    if (php_git2_oid_binary()) {
+        memcpy(buf,oid->id,GIT_OID_RAWSZ);
+        return GIT_OID_RAWSZ;
+    }
+
+    oid_fmt_hex(buf,oid);
+    return GIT_OID_HEXSZ;
+}
+
 void php_git2::convert_oid(zval* zv,const git_oid* oid)
 {
-    char buf[GIT_OID_HEXSZ + 1];
+    char buf[GIT_OID_HEXSZ];
+    size_t len;
 
-    git_oid_tostr(buf,sizeof(buf),oid);
+    len = convert_oid_buffer(buf,oid);
+    ZVAL_STRINGL(zv,buf,len);
+}
+
+void php_git2::convert_oid_hex(zval* zv,const git_oid* oid)
+{
+    char buf[GIT_OID_HEXSZ];
+
+    oid_fmt_hex(buf,oid);
     ZVAL_STRINGL(zv,buf,GIT_OID_HEXSZ);
 }
 
@@ -418,6 +984,38 @@ void php_git2::convert_oid_prefix(zval* zv,const git_oid* prefix,size_t len)
     ZVAL_STRING(zv,buf);
 }
 
+size_t php_git2::convert_oid_array(git_oid** out,zval* zarr)
+{
+    // Parse each OID string from the array. The OIDs keep the order of the
+    // array.
+
+    zval* zoid;
+    size_t n = 0;
+    git_oid* oids;
+    HashTable* ht = Z_ARRVAL_P(zarr);
+
+    oids = reinterpret_cast<git_oid*>(
+        safe_emalloc(zend_hash_num_elements(ht),sizeof(git_oid),0));
+
+    ZEND_HASH_FOREACH_VAL(ht,zoid) {
+        ZVAL_DEREF(zoid);
+
+        if (Z_TYPE_P(zoid) != IS_STRING
+            || (Z_STRLEN_P(zoid) != GIT_OID_HEXSZ && Z_STRLEN_P(zoid) != GIT_OID_RAWSZ)
+            || convert_oid_fromstr(oids + n,Z_STRVAL_P(zoid),Z_STRLEN_P(zoid)) < 0)
+        {
+            efree(oids);
+            giterr_clear();
+            throw php_git2_error_exception("Array element is not a valid OID string");
+        }
+
+        n += 1;
+    } ZEND_HASH_FOREACH_END();
+
+    *out = oids;
+    return n;
+}
+
 void php_git2::convert_transfer_progress(zval* zv,const git_transfer_progress* stats)
 {
     if (stats == nullptr) {
@@ -425,19 +1023,19 @@ void php_git2::convert_transfer_progress(zval* zv,const git_transfer_progress* s
         return;
     }
 
-    array_init(zv);
-    add_assoc_long_ex(zv,"total_objects",sizeof("total_objects")-1,stats->total_objects);
-    add_assoc_long_ex(zv,"indexed_objects",sizeof("indexed_objects")-1,stats->indexed_objects);
-    add_assoc_long_ex(zv,"received_objects",sizeof("received_objects")-1,stats->received_objects);
-    add_assoc_long_ex(zv,"local_objects",sizeof("local_objects")-1,stats->local_objects);
-    add_assoc_long_ex(zv,"total_deltas",sizeof("total_deltas")-1,stats->total_deltas);
-    add_assoc_long_ex(zv,"indexed_deltas",sizeof("indexed_deltas")-1,stats->indexed_deltas);
-    add_assoc_long_ex(zv,"received_bytes",sizeof("received_bytes")-1,stats->received_bytes);
+    array_template_writer arr(zv,TEMPLATE_TRANSFER_PROGRESS);
+    arr.put_long(stats->total_objects);
+    arr.put_long(stats->indexed_objects);
+    arr.put_long(stats->received_objects);
+    arr.put_long(stats->local_objects);
+    arr.put_long(stats->total_deltas);
+    arr.put_long(stats->indexed_deltas);
+    arr.put_long(stats->received_bytes);
 }
 
 void php_git2::convert_blame_hunk(zval* zv,const git_blame_hunk* hunk)
 {
-    char buf[GIT_OID_HEXSZ + 1];
+    char buf[2];
 
     if (hunk == nullptr) {
         ZVAL_NULL(zv);
@@ -450,48 +1048,40 @@ void php_git2::convert_blame_hunk(zval* zv,const git_blame_hunk* hunk)
     // in reading the data then having the values in the "proper" format
     // (e.g. git_signature resource type, ETC.).
 
-    array_init(zv);
-    add_assoc_long(zv,"lines_in_hunk",hunk->lines_in_hunk);
-    git_oid_tostr(buf,sizeof(buf),&hunk->final_commit_id);
-    add_assoc_string(zv,"final_commit_id",buf);
-    add_assoc_long(zv,"final_start_line_number",hunk->final_start_line_number);
-    add_assoc_string(zv,"final_signature.name",hunk->final_signature->name);
-    add_assoc_string(zv,"final_signature.email",hunk->final_signature->email);
-    add_assoc_long(zv,"final_signature.when.time",hunk->final_signature->when.time);
-    add_assoc_long(zv,"final_signature.when.offset",hunk->final_signature->when.offset);
-    git_oid_tostr(buf,sizeof(buf),&hunk->orig_commit_id);
-    add_assoc_string(zv,"orig_commit_id",buf);
-    add_assoc_string(zv,"orig_path",const_cast<char*>(hunk->orig_path));
-    add_assoc_long(zv,"orig_start_line_number",hunk->orig_start_line_number);
-    add_assoc_string(zv,"orig_signature.name",hunk->orig_signature->name);
-    add_assoc_string(zv,"orig_signature.email",hunk->orig_signature->email);
-    add_assoc_long(zv,"orig_signature.when.time",hunk->orig_signature->when.time);
-    add_assoc_long(zv,"orig_signature.when.offset",hunk->orig_signature->when.offset);
+    array_template_writer arr(zv,TEMPLATE_BLAME_HUNK);
+    arr.put_long(hunk->lines_in_hunk);
+    arr.put_oid(&hunk->final_commit_id);
+    arr.put_long(hunk->final_start_line_number);
+    arr.put_string(hunk->final_signature->name);
+    arr.put_string(hunk->final_signature->email);
+    arr.put_long(hunk->final_signature->when.time);
+    arr.put_long(hunk->final_signature->when.offset);
+    arr.put_oid(&hunk->orig_commit_id);
+    arr.put_string(hunk->orig_path);
+    arr.put_long(hunk->orig_start_line_number);
+    arr.put_string(hunk->orig_signature->name);
+    arr.put_string(hunk->orig_signature->email);
+    arr.put_long(hunk->orig_signature->when.time);
+    arr.put_long(hunk->orig_signature->when.offset);
     buf[0] = hunk->boundary;
     buf[1] = 0;
-    add_assoc_string(zv,"boundary",buf);
+    arr.put_string(buf);
 }
 
 void php_git2::convert_diff_delta(zval* zv,const git_diff_delta* delta)
 {
-    zval zfile;
-
     if (delta == nullptr) {
         ZVAL_NULL(zv);
         return;
     }
 
-    array_init(zv);
-    add_assoc_long_ex(zv,"status",sizeof("status")-1,delta->status);
-    add_assoc_long_ex(zv,"flags",sizeof("flags")-1,delta->flags);
-    add_assoc_long_ex(zv,"similarity",sizeof("similarity")-1,delta->similarity);
-    add_assoc_long_ex(zv,"nfiles",sizeof("nfiles")-1,delta->nfiles);
-
-    convert_diff_file(&zfile,&delta->old_file);
-    add_assoc_zval_ex(zv,"old_file",sizeof("old_file")-1,&zfile);
-
-    convert_diff_file(&zfile,&delta->new_file);
-    add_assoc_zval_ex(zv,"new_file",sizeof("new_file")-1,&zfile);
+    array_template_writer arr(zv,TEMPLATE_DIFF_DELTA);
+    arr.put_long(delta->status);
+    arr.put_long(delta->flags);
+    arr.put_long(delta->similarity);
+    arr.put_long(delta->nfiles);
+    convert_diff_file(arr.put_zval(),&delta->old_file);
+    convert_diff_file(arr.put_zval(),&delta->new_file);
 }
 
 void php_git2::convert_diff_file(zval* zv,const git_diff_file* file)
@@ -502,39 +1092,38 @@ void php_git2::convert_diff_file(zval* zv,const git_diff_file* file)
     }
 
     uint16_t idlen = file->id_abbrev;
-    char buf[GIT_OID_HEXSZ + 1];
+    char buf[GIT_OID_HEXSZ];
 
-    if (idlen == 0 || idlen > GIT_OID_HEXSZ) {
-        idlen = GIT_OID_HEXSZ;
+    // NOTE: Abbreviation only applies to hex OIDs.
+    if (php_git2_oid_binary()) {
+        idlen = convert_oid_buffer(buf,&file->id);
+    }
+    else {
+        if (idlen == 0 || idlen > GIT_OID_HEXSZ) {
+            idlen = GIT_OID_HEXSZ;
+        }
+        oid_fmt_hex(buf,&file->id);
     }
-    git_oid_tostr(buf,sizeof(buf),&file->id);
-    buf[idlen] = 0;
 
-    array_init(zv);
-    add_assoc_stringl(zv,"id",buf,idlen);
-    add_assoc_string(zv,"path",const_cast<char*>(file->path));
-    add_assoc_long_ex(zv,"size",sizeof("size")-1,file->size);
-    add_assoc_long_ex(zv,"flags",sizeof("flags")-1,file->flags);
-    add_assoc_long_ex(zv,"mode",sizeof("mode")-1,file->mode);
+    array_template_writer arr(zv,TEMPLATE_DIFF_FILE);
+    arr.put_stringl(buf,idlen);
+    arr.put_string(file->path);
+    arr.put_long(file->size);
+    arr.put_long(file->flags);
+    arr.put_long(file->mode);
 }
 
 void php_git2::convert_diff_binary(zval* zv,const git_diff_binary* binary)
 {
-    zval zold;
-    zval znew;
-
     if (binary == nullptr) {
         ZVAL_NULL(zv);
         return;
     }
 
-    array_init(zv);
-    add_assoc_bool_ex(zv,"contains_data",sizeof("contains_data")-1,binary->contains_data);
-
-    convert_diff_binary_file(&zold,&binary->old_file);
-    convert_diff_binary_file(&znew,&binary->new_file);
-    add_assoc_zval_ex(zv,"old_file",sizeof("old_file")-1,&zold);
-    add_assoc_zval_ex(zv,"new_file",sizeof("new_file")-1,&znew);
+    array_template_writer arr(zv,TEMPLATE_DIFF_BINARY);
+    arr.put_bool(binary->contains_data);
+    convert_diff_binary_file(arr.put_zval(),&binary->old_file);
+    convert_diff_binary_file(arr.put_zval(),&binary->new_file);
 }
 
 void php_git2::convert_diff_binary_file(zval* zv,const git_diff_binary_file* file)
@@ -544,19 +1133,15 @@ void php_git2::convert_diff_binary_file(zval* zv,const git_diff_binary_file* fil
         return;
     }
 
-    array_init(zv);
-    add_assoc_long_ex(zv,"type",sizeof("type")-1,file->type);
+    array_template_writer arr(zv,TEMPLATE_DIFF_BINARY_FILE);
+    arr.put_long(file->type);
     if (file->data == nullptr || file->datalen == 0) {
-        add_assoc_null_ex(zv,"data",sizeof("data")-1);
+        arr.put_null();
     }
     else {
-        add_assoc_stringl_ex(zv,
-            "data",
-            sizeof("data")-1,
-            const_cast<char*>(file->data),
-            file->datalen);
+        arr.put_stringl(file->data,file->datalen);
     }
-    add_assoc_long_ex(zv,"inflatedlen",sizeof("inflatedlen")-1,file->inflatedlen);
+    arr.put_long(file->inflatedlen);
 }
 
 void php_git2::convert_diff_hunk(zval* zv,const git_diff_hunk* hunk)
@@ -566,14 +1151,14 @@ void php_git2::convert_diff_hunk(zval* zv,const git_diff_hunk* hunk)
         return;
     }
 
-    array_init(zv);
-    add_assoc_long_ex(zv,"old_start",sizeof("old_start")-1,hunk->old_start);
-    add_assoc_long_ex(zv,"old_lines",sizeof("old_lines")-1,hunk->old_lines);
-    add_assoc_long_ex(zv,"new_start",sizeof("new_start")-1,hunk->new_start);
-    add_assoc_long_ex(zv,"new_lines",sizeof("new_lines")-1,hunk->new_lines);
+    array_template_writer arr(zv,TEMPLATE_DIFF_HUNK);
+    arr.put_long(hunk->old_start);
+    arr.put_long(hunk->old_lines);
+    arr.put_long(hunk->new_start);
+    arr.put_long(hunk->new_lines);
 
     // The header is NUL terminated so we just let PHP copy it over.
-    add_assoc_string_ex(zv,"header",sizeof("header")-1,const_cast<char*>(hunk->header));
+    arr.put_string(hunk->header);
 }
 
 void php_git2::convert_diff_line(zval* zv,const git_diff_line* line)
@@ -583,145 +1168,215 @@ void php_git2::convert_diff_line(zval* zv,const git_diff_line* line)
         return;
     }
 
-    array_init(zv);
-    add_assoc_long_ex(zv,"origin",sizeof("origin")-1,line->origin);
-    add_assoc_long_ex(zv,"old_lineno",sizeof("old_lineno")-1,line->old_lineno);
-    add_assoc_long_ex(zv,"new_lineno",sizeof("new_lineno")-1,line->new_lineno);
-    add_assoc_long_ex(zv,"num_lines",sizeof("num_lines")-1,line->num_lines);
-    add_assoc_long_ex(zv,"content_offset",sizeof("content_offset")-1,line->content_offset);
-    add_assoc_stringl_ex(zv,
-        "content",
-        sizeof("content")-1,
-        const_cast<char*>(line->content),
-        line->content_len);
+    array_template_writer arr(zv,TEMPLATE_DIFF_LINE);
+    arr.put_long(line->origin);
+    arr.put_long(line->old_lineno);
+    arr.put_long(line->new_lineno);
+    arr.put_long(line->num_lines);
+    arr.put_long(line->content_offset);
+    arr.put_stringl(line->content,line->content_len);
 }
 
 void php_git2::convert_diff_perfdata(zval* zv,const git_diff_perfdata* perfdata)
 {
-    array_init(zv);
-    add_assoc_long_ex(zv,"stat_calls",sizeof("stat_calls")-1,perfdata->stat_calls);
-    add_assoc_long_ex(zv,"oid_calculations",sizeof("oid_calculations")-1,perfdata->oid_calculations);
+    array_template_writer arr(zv,TEMPLATE_DIFF_PERFDATA);
+    arr.put_long(perfdata->stat_calls);
+    arr.put_long(perfdata->oid_calculations);
 }
 
-void php_git2::convert_signature(zval* zv,const git_signature* sig)
+// Looks up 'str' in a table of strings shared by a bulk conversion, adding it if
+// it is not present. The returned string is owned by the table.
+static zend_string* intern_string(HashTable* strings,const char* str)
 {
-    array_init(zv);
-    add_assoc_string(zv,"name",sig->name);
-    add_assoc_string(zv,"email",sig->email);
-    add_assoc_long(zv,"when.time",sig->when.time);
-    add_assoc_long(zv,"when.offset",sig->when.offset);
+    size_t len = strlen(str);
+    zval* zv;
+
+    zv = zend_hash_str_find(strings,str,len);
+    if (zv == nullptr) {
+        zval zstr;
+
+        ZVAL_STRINGL(&zstr,str,len);
+        zv = zend_hash_add_new(strings,Z_STR(zstr),&zstr);
+    }
+
+    return Z_STR_P(zv);
 }
 
-void php_git2::convert_index_entry(zval* zv,const git_index_entry* ent)
+void php_git2::convert_signature(zval* zv,const git_signature* sig,HashTable* strings)
 {
-    zval zctime;
-    zval zmtime;
-    char buf[GIT_OID_HEXSZ + 1];
+    array_template_writer arr(zv,TEMPLATE_SIGNATURE);
+
+    // If a string table is provided, then names and emails are shared between
+    // signatures since they tend to repeat across many commits.
 
-    array_init(zv);
-    convert_index_time(&zctime,&ent->ctime);
-    convert_index_time(&zmtime,&ent->mtime);
-    add_assoc_zval(zv,"ctime",&zctime);
-    add_assoc_zval(zv,"mtime",&zmtime);
-    add_assoc_long_ex(zv,"dev",sizeof("dev")-1,ent->dev);
-    add_assoc_long_ex(zv,"ino",sizeof("ino")-1,ent->ino);
-    add_assoc_long_ex(zv,"mode",sizeof("mode")-1,ent->mode);
-    add_assoc_long_ex(zv,"uid",sizeof("uid")-1,ent->uid);
-    add_assoc_long_ex(zv,"gid",sizeof("gid")-1,ent->gid);
-    add_assoc_long_ex(zv,"file_size",sizeof("file_size")-1,ent->file_size);
-    git_oid_tostr(buf,sizeof(buf),&ent->id);
-    add_assoc_string_ex(zv,"id",sizeof("id")-1,buf);
-    add_assoc_long_ex(zv,"flags",sizeof("flags")-1,ent->flags);
-    add_assoc_long_ex(zv,"flags_extended",sizeof("flags_extended")-1,ent->flags_extended);
-    if (ent->path != nullptr) {
-        add_assoc_string_ex(zv,"path",sizeof("path")-1,const_cast<char*>(ent->path));
+    if (strings != nullptr) {
+        arr.put_str(intern_string(strings,sig->name));
+        arr.put_str(intern_string(strings,sig->email));
     }
     else {
-        add_assoc_null_ex(zv,"path",sizeof("path")-1);
+        arr.put_string(sig->name);
+        arr.put_string(sig->email);
     }
+
+    arr.put_long(sig->when.time);
+    arr.put_long(sig->when.offset);
+}
+
+void php_git2::convert_commit_info(zval* zv,git_commit* commit,zend_long fields,
+    HashTable* strings)
+{
+    HashTable* ht;
+    zval zfield;
+
+    // Only the requested fields are converted. Like convert_status_entry(), we
+    // use permanent keys since the set of keys varies.
+
+    array_init_size(zv,_COMMIT_KEY_COUNT);
+    ht = Z_ARRVAL_P(zv);
+
+    if (fields & GIT2_COMMIT_INFO_ID) {
+        convert_oid(&zfield,git_commit_id(commit));
+        add_permanent_key(ht,commitInfoKeys[COMMIT_KEY_ID],&zfield);
+    }
+    if (fields & GIT2_COMMIT_INFO_TREE_ID) {
+        convert_oid(&zfield,git_commit_tree_id(commit));
+        add_permanent_key(ht,commitInfoKeys[COMMIT_KEY_TREE_ID],&zfield);
+    }
+    if (fields & GIT2_COMMIT_INFO_PARENT_IDS) {
+        unsigned int count = git_commit_parentcount(commit);
+
+        array_init_size(&zfield,count);
+        for (unsigned int i = 0;i < count;++i) {
+            zval zoid;
+
+            convert_oid(&zoid,git_commit_parent_id(commit,i));
+            add_next_index_zval(&zfield,&zoid);
+        }
+
+        add_permanent_key(ht,commitInfoKeys[COMMIT_KEY_PARENT_IDS],&zfield);
+    }
+    if (fields & GIT2_COMMIT_INFO_AUTHOR) {
+        convert_signature(&zfield,git_commit_author(commit),strings);
+        add_permanent_key(ht,commitInfoKeys[COMMIT_KEY_AUTHOR],&zfield);
+    }
+    if (fields & GIT2_COMMIT_INFO_COMMITTER) {
+        convert_signature(&zfield,git_commit_committer(commit),strings);
+        add_permanent_key(ht,commitInfoKeys[COMMIT_KEY_COMMITTER],&zfield);
+    }
+    if (fields & GIT2_COMMIT_INFO_MESSAGE) {
+        ZVAL_STRING(&zfield,git_commit_message(commit));
+        add_permanent_key(ht,commitInfoKeys[COMMIT_KEY_MESSAGE],&zfield);
+    }
+    if (fields & GIT2_COMMIT_INFO_SUMMARY) {
+        const char* summary = git_commit_summary(commit);
+
+        if (summary != nullptr) {
+            ZVAL_STRING(&zfield,summary);
+        }
+        else {
+            ZVAL_NULL(&zfield);
+        }
+
+        add_permanent_key(ht,commitInfoKeys[COMMIT_KEY_SUMMARY],&zfield);
+    }
+    if (fields & GIT2_COMMIT_INFO_TIME) {
+        ZVAL_LONG(&zfield,git_commit_time(commit));
+        add_permanent_key(ht,commitInfoKeys[COMMIT_KEY_TIME],&zfield);
+        ZVAL_LONG(&zfield,git_commit_time_offset(commit));
+        add_permanent_key(ht,commitInfoKeys[COMMIT_KEY_TIME_OFFSET],&zfield);
+    }
+    if (fields & GIT2_COMMIT_INFO_ENCODING) {
+        const char* encoding = git_commit_message_encoding(commit);
+
+        if (encoding != nullptr) {
+            ZVAL_STRING(&zfield,encoding);
+        }
+        else {
+            ZVAL_NULL(&zfield);
+        }
+
+        add_permanent_key(ht,commitInfoKeys[COMMIT_KEY_MESSAGE_ENCODING],&zfield);
+    }
+}
+
+void php_git2::convert_index_entry(zval* zv,const git_index_entry* ent)
+{
+    array_template_writer arr(zv,TEMPLATE_INDEX_ENTRY);
+    convert_index_time(arr.put_zval(),&ent->ctime);
+    convert_index_time(arr.put_zval(),&ent->mtime);
+    arr.put_long(ent->dev);
+    arr.put_long(ent->ino);
+    arr.put_long(ent->mode);
+    arr.put_long(ent->uid);
+    arr.put_long(ent->gid);
+    arr.put_long(ent->file_size);
+    arr.put_oid(&ent->id);
+    arr.put_long(ent->flags);
+    arr.put_long(ent->flags_extended);
+    arr.put_string(ent->path);
 }
 
 void php_git2::convert_index_time(zval* zv,const git_index_time* tv)
 {
-    array_init(zv);
-    add_assoc_long(zv,"seconds",tv->seconds);
-    add_assoc_long(zv,"nanoseconds",tv->nanoseconds);
+    array_template_writer arr(zv,TEMPLATE_INDEX_TIME);
+    arr.put_long(tv->seconds);
+    arr.put_long(tv->nanoseconds);
 }
 
 void php_git2::convert_status_entry(zval* zv,const git_status_entry* ent)
 {
-    array_init(zv);
-    add_assoc_long(zv,"status",ent->status);
+    zval zstatus;
+
+    // The set of keys varies, so we cannot use a template. We still use the
+    // permanent keys and presize the array.
+
+    array_init_size(zv,3);
+    ZVAL_LONG(&zstatus,ent->status);
+    add_permanent_key(Z_ARRVAL_P(zv),keyStatus,&zstatus);
 
     if (ent->head_to_index) {
         zval zheadToIndex;
 
         convert_diff_delta(&zheadToIndex,ent->head_to_index);
-        add_assoc_zval_ex(zv,"head_to_index",sizeof("head_to_index")-1,&zheadToIndex);
+        add_permanent_key(Z_ARRVAL_P(zv),keyHeadToIndex,&zheadToIndex);
     }
     if (ent->index_to_workdir) {
         zval zindexToWorkdir;
 
         convert_diff_delta(&zindexToWorkdir,ent->index_to_workdir);
-        add_assoc_zval_ex(zv,
-            "index_to_workdir",
-            sizeof("index_to_workdir")-1,
-            &zindexToWorkdir);
+        add_permanent_key(Z_ARRVAL_P(zv),keyIndexToWorkdir,&zindexToWorkdir);
     }
 }
 
 void php_git2::convert_merge_file_result(zval* zv,const git_merge_file_result* res)
 {
-    array_init(zv);
-    add_assoc_bool(zv,"automergeable",res->automergeable);
-    if (res->path == nullptr) {
-        add_assoc_null(zv,"path");
-    }
-    else {
-        add_assoc_string(zv,"path",const_cast<char*>(res->path));
-    }
-    add_assoc_long(zv,"mode",res->mode);
-    add_assoc_stringl(zv,"ptr",const_cast<char*>(res->ptr),res->len);
+    array_template_writer arr(zv,TEMPLATE_MERGE_FILE_RESULT);
+    arr.put_bool(res->automergeable);
+    arr.put_string(res->path);
+    arr.put_long(res->mode);
+    arr.put_stringl(res->ptr,res->len);
 }
 
 void php_git2::convert_reflog_entry(zval* zv,const git_reflog_entry* ent)
 {
-    const char* msg;
-    zval znewid;
-    zval zoldid;
-    zval zsig;
-
-    array_init(zv);
-
-    convert_signature(&zsig,git_reflog_entry_committer(ent));
-    add_assoc_zval_ex(zv,"committer",sizeof("committer")-1,&zsig);
-
-    convert_oid(&znewid,git_reflog_entry_id_new(ent));
-    add_assoc_zval_ex(zv,"id_new",sizeof("id_new")-1,&znewid);
-
-    convert_oid(&zoldid,git_reflog_entry_id_old(ent));
-    add_assoc_zval_ex(zv,"id_old",sizeof("id_old")-1,&zoldid);
-
-    msg = git_reflog_entry_message(ent);
-    if (msg == nullptr) {
-        add_assoc_null(zv,"message");
-    }
-    else {
-        add_assoc_string(zv,"message",const_cast<char*>(msg));
-    }
+    array_template_writer arr(zv,TEMPLATE_REFLOG_ENTRY);
+    convert_signature(arr.put_zval(),git_reflog_entry_committer(ent));
+    arr.put_oid(git_reflog_entry_id_new(ent));
+    arr.put_oid(git_reflog_entry_id_old(ent));
+    arr.put_string(git_reflog_entry_message(ent));
 }
 
 void php_git2::convert_reflog(zval* zv,const git_reflog* log)
 {
     size_t count;
 
-    array_init(zv);
-
     // NOTE: For some reason, libgit2 has git_reflog_entrycount take a non-const
     // reflog pointer. According to the source code, the function is read-only,
     // so a const-cast is acceptable here to get around the inconvenience of the
     // function's signature.
     count = git_reflog_entrycount(const_cast<git_reflog*>(log));
+
+    array_init_size(zv,count);
     for (size_t i = 0;i < count;++i) {
         zval zentry;
         const git_reflog_entry* ent = git_reflog_entry_byindex(log,i);
@@ -733,69 +1388,46 @@ void php_git2::convert_reflog(zval* zv,const git_reflog* log)
 
 void php_git2::convert_rebase_operation(zval* zv,const git_rebase_operation* oper)
 {
-    zval zid;
-
-    array_init(zv);
-
-    add_assoc_long(zv,"type",oper->type);
-
-    convert_oid(&zid,&oper->id);
-    add_assoc_zval_ex(zv,"id",sizeof("id")-1,&zid);
-
-    if (oper->exec != nullptr) {
-        add_assoc_string(zv,"exec",const_cast<char*>(oper->exec));
-    }
-    else {
-        add_assoc_null(zv,"exec");
-    }
+    array_template_writer arr(zv,TEMPLATE_REBASE_OPERATION);
+    arr.put_long(oper->type);
+    arr.put_oid(&oper->id);
+    arr.put_string(oper->exec);
 }
 
 void php_git2::convert_cert(zval* zv,const git_cert* cert)
 {
-    array_init(zv);
-
-    add_assoc_long(zv,"cert_type",cert->cert_type);
+    array_template_writer arr(zv,TEMPLATE_CERT);
+    arr.put_long(cert->cert_type);
 }
 
 void php_git2::convert_push_update(zval* zv,const git_push_update* up)
 {
-    zval zoidsrc;
-    zval zoiddst;
-
-    array_init(zv);
-
-    add_assoc_string(zv,"src_refname",up->src_refname);
-    add_assoc_string(zv,"dst_refname",up->dst_refname);
-
-    convert_oid(&zoidsrc,&up->src);
-    convert_oid(&zoiddst,&up->dst);
-
-    add_assoc_zval(zv,"src",&zoidsrc);
-    add_assoc_zval(zv,"dst",&zoiddst);
+    array_template_writer arr(zv,TEMPLATE_PUSH_UPDATE);
+    arr.put_string(up->src_refname);
+    arr.put_string(up->dst_refname);
+    arr.put_oid(&up->src);
+    arr.put_oid(&up->dst);
 }
 
 void php_git2::convert_remote_head(zval* zv,const git_remote_head* head)
 {
-    zval zoid;
-    zval zloid;
-
-    array_init(zv);
-
-    add_assoc_bool(zv,"local",head->local);
-
-    convert_oid(&zoid,&head->oid);
-    convert_oid(&zloid,&head->loid);
+    array_template_writer arr(zv,TEMPLATE_REMOTE_HEAD);
+    arr.put_bool(head->local);
+    arr.put_oid(&head->oid);
+    arr.put_oid(&head->loid);
+    arr.put_string(head->name);
+    arr.put_string(head->symref_target);
+}
 
-    add_assoc_zval(zv,"oid",&zoid);
-    add_assoc_zval(zv,"loid",&zloid);
+void php_git2::convert_tree_list_entry(zval* zv,zend_string* path,const git_tree_entry* ent)
+{
+    // NOTE: The path string is consumed by the array.
 
-    add_assoc_string(zv,"name",head->name);
-    if (head->symref_target != nullptr) {
-        add_assoc_string(zv,"symref_target",head->symref_target);
-    }
-    else {
-        add_assoc_null(zv,"symref_target");
-    }
+    array_template_writer arr(zv,TEMPLATE_TREE_LIST_ENTRY);
+    ZVAL_STR(arr.put_zval(),path);
+    arr.put_long(git_tree_entry_filemode(ent));
+    arr.put_long(git_tree_entry_type(ent));
+    arr.put_oid(git_tree_entry_id(ent));
 }
 
 git_signature* php_git2::convert_signature(zval* zv)
@@ -22,6 +22,7 @@ extern "C" {
 #include <ext/standard/php_incomplete_class.h>
 #include <ext/standard/info.h>
 #include <ext/standard/php_array.h>
+#include <zend_smart_str.h>
 #undef lookup
 }
 
@@ -33,6 +34,9 @@ extern "C" {
 #include <git2.h>
 #include <git2/trace.h>
 #include <git2/sys/diff.h>
+#include <git2/sys/commit_graph.h>
+#include <git2/sys/midx.h>
+#include <git2/sys/mempack.h>
 }
 
 // Include any C/C++ standard libraries.
@@ -43,11 +47,32 @@ extern "C" {
 #include <cstdio>
 #include <cstdarg>
 
+// Callback deferred until the outermost call into libgit2 returns.
+
+typedef int (*php_git2_write_scope_callback)(void* payload);
+
+struct php_git2_write_scope_entry
+{
+    php_git2_write_scope_callback callback;
+    void* payload;
+};
+
 // Module globals
 
 ZEND_BEGIN_MODULE_GLOBALS(git2)
   bool propagateError;
   bool requestActive;
+  zend_long persistentReposMax;
+  zend_long persistentReposTTL;
+  HashTable* persistentRepos;
+  zend_long oidFormat;
+  unsigned writeScopeDepth;
+  php_git2_write_scope_entry* writeScopeEntries;
+  size_t writeScopeCount;
+  size_t writeScopeCapacity;
+#ifdef HAVE_GIT2_SQLITE
+  zend_long sqliteBusyTimeout;
+#endif
 ZEND_END_MODULE_GLOBALS(git2)
 ZEND_EXTERN_MODULE_GLOBALS(git2)
 
@@ -75,6 +100,29 @@ ZEND_EXTERN_MODULE_GLOBALS(git2)
 #define GIT_EPHP_PROP           -30002
 #define GIT_EPHP_PROP_BAILOUT   -30003
 
+// Define flags used by functions that are specific to this extension. These
+// are registered as PHP constants.
+
+#define GIT2_DIFF_MATERIALIZE_OFFSETS   (1 << 0)
+
+#define GIT2_OID_HEX                    0
+#define GIT2_OID_BINARY                 1
+
+#define GIT2_COMMIT_INFO_ID             (1 << 0)
+#define GIT2_COMMIT_INFO_TREE_ID        (1 << 1)
+#define GIT2_COMMIT_INFO_PARENT_IDS     (1 << 2)
+#define GIT2_COMMIT_INFO_AUTHOR         (1 << 3)
+#define GIT2_COMMIT_INFO_COMMITTER      (1 << 4)
+#define GIT2_COMMIT_INFO_MESSAGE        (1 << 5)
+#define GIT2_COMMIT_INFO_SUMMARY        (1 << 6)
+#define GIT2_COMMIT_INFO_TIME           (1 << 7)
+#define GIT2_COMMIT_INFO_ENCODING       (1 << 8)
+#define GIT2_COMMIT_INFO_ALL            ((1 << 9) - 1)
+
+// Flags for git2_tree_list().
+#define GIT2_TREE_LIST_COLUMNAR         (1 << 0)
+#define GIT2_TREE_LIST_BLOBS_ONLY       (1 << 1)
+
 namespace php_git2
 {
     // List of all functions provided in the php-git2-fe compilation unit.
@@ -354,11 +402,90 @@ namespace php_git2
     void php_git2_globals_request_init();
     void php_git2_globals_request_shutdown();
 
+    // Functions to manage the pool of persistent repository handles. The pool
+    // is owned by the module globals and outlives individual requests.
+
+    git_repository* php_git2_persistent_repository_open(const char* path,size_t len);
+    bool php_git2_persistent_repository_is_pooled(git_repository* repo);
+    void php_git2_persistent_repository_trim();
+    void php_git2_persistent_repository_destroy(zend_git2_globals* gbls);
+
+    // Returns the modification time from a stat buffer in nanoseconds. Only
+    // whole seconds are available on platforms without sub-second timestamps.
+
+    inline int64_t php_git2_stat_mtime(const zend_stat_t& st)
+    {
+        int64_t mtime = static_cast<int64_t>(st.st_mtime) * 1000000000;
+
+#if defined(__APPLE__)
+        mtime += st.st_mtimespec.tv_nsec;
+#elif defined(__linux__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
+        mtime += st.st_mtim.tv_nsec;
+#endif
+
+        return mtime;
+    }
+
+    // Functions to manage global libgit2 options (i.e. git_libgit2_opts()).
+
+    void php_git2_opts_init();
+    void php_git2_opts_request_init();
+    void php_git2_opts_info();
+    void php_git2_opts_set(const char* name,size_t len,zval* zv);
+    void php_git2_opts_get(zval* zv,const char* name,size_t len);
+
+    // Functions to manage the git2:// stream wrapper and create PHP streams
+    // that read from libgit2 storage without copying it into PHP strings.
+
+    void php_git2_register_stream_wrapper();
+    void php_git2_unregister_stream_wrapper();
+    php_stream* php_git2_make_blob_stream(zval* owner,git_blob* blob);
+    php_stream* php_git2_make_odb_read_stream(zval* owner,git_odb_stream* odbStream);
+
+    // Functions that track nested calls into libgit2. Backends that buffer
+    // writes defer a callback that flushes them when the outermost call
+    // returns. A callback is deferred at most once per payload.
+
+    void php_git2_write_scope_enter();
+    void php_git2_write_scope_leave();
+    bool php_git2_write_scope_active();
+    void php_git2_write_scope_defer(php_git2_write_scope_callback callback,void* payload);
+    void php_git2_write_scope_cancel(void* payload);
+
+#ifdef HAVE_GIT2_SQLITE
+    // Creates a native ODB backend that stores objects in a SQLite database.
+    // The busy timeout is given in milliseconds.
+
+    int php_git2_odb_backend_sqlite(git_odb_backend** out,
+        const char* path,
+        int busyTimeout);
+#endif
+
+    // Functions to create/destroy the prebuilt arrays used by the convert_*
+    // helpers.
+
+    void php_git2_convert_init();
+    void php_git2_convert_shutdown();
+
     // Helper functions for converting git2 values to PHP values.
 
+    // NOTE: convert_oid_fromstr(), convert_oid() and convert_oid_buffer() honor
+    // the OID format selected by git2.oid_format. The hex variants always use
+    // hex strings; they are used by custom backends since backend data is
+    // typically persisted.
+
+    inline bool php_git2_oid_binary()
+    {
+        return GIT2_G(oidFormat) == GIT2_OID_BINARY;
+    }
+
     int convert_oid_fromstr(git_oid* dest,const char* src,size_t srclen);
+    int convert_oid_fromhex(git_oid* dest,const char* src,size_t srclen);
+    size_t convert_oid_buffer(char* buf,const git_oid* oid);
     void convert_oid(zval* zv,const git_oid* oid);
+    void convert_oid_hex(zval* zv,const git_oid* oid);
     void convert_oid_prefix(zval* zv,const git_oid* prefix,size_t len);
+    size_t convert_oid_array(git_oid** out,zval* zarr);
     void convert_transfer_progress(zval* zv,const git_transfer_progress* stats);
     void convert_blame_hunk(zval* zv,const git_blame_hunk* hunk);
     void convert_diff_delta(zval* zv,const git_diff_delta* delta);
@@ -368,7 +495,9 @@ namespace php_git2
     void convert_diff_hunk(zval* zv,const git_diff_hunk* hunk);
     void convert_diff_line(zval* zv,const git_diff_line* line);
     void convert_diff_perfdata(zval* zv,const git_diff_perfdata* perfdata);
-    void convert_signature(zval* zv,const git_signature* sig);
+    void convert_signature(zval* zv,const git_signature* sig,HashTable* strings = nullptr);
+    void convert_commit_info(zval* zv,git_commit* commit,zend_long fields,
+        HashTable* strings = nullptr);
     void convert_index_entry(zval* zv,const git_index_entry* ent);
     void convert_index_time(zval* zv,const git_index_time* tv);
     void convert_status_entry(zval* zv,const git_status_entry *ent);
@@ -379,6 +508,7 @@ namespace php_git2
     void convert_cert(zval* zv,const git_cert* cert);
     void convert_push_update(zval* zv,const git_push_update* up);
     void convert_remote_head(zval* zv,const git_remote_head* head);
+    void convert_tree_list_entry(zval* zv,zend_string* path,const git_tree_entry* ent);
 
     // Helper functions for converting PHP values to git2 values.
 
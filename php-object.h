@@ -9,6 +9,10 @@
 #include "php-type.h"
 #include "php-callback.h"
 #include <new>
+#include <list>
+#include <memory>
+#include <vector>
+#include <unordered_map>
 extern "C" {
 #include <git2/sys/odb_backend.h>
 #include <git2/sys/refdb_backend.h>
@@ -215,6 +219,194 @@ namespace php_git2
         zval zretval;
     };
 
+    // Provide a byte-bounded LRU cache of objects read through a custom ODB
+    // backend. The cache is consulted before calling into userspace. An entry
+    // may hold just the object header (size and type) if the object was never
+    // read in full.
+
+    class php_odb_backend_cache
+    {
+    public:
+        php_odb_backend_cache();
+
+        bool read(void** bufferp,
+            size_t* sizep,
+            git_object_t* typep,
+            git_odb_backend* backend,
+            const git_oid* oid);
+        bool read_header(size_t* sizep,git_object_t* typep,const git_oid* oid);
+        bool exists(const git_oid* oid);
+
+        bool contains(const git_oid* oid) const;
+
+        void put(const git_oid* oid,const void* data,size_t size,git_object_t type);
+        void put_header(const git_oid* oid,size_t size,git_object_t type);
+        void remove(const git_oid* oid);
+
+        void set_capacity(size_t bytes);
+        void clear();
+        void get_stats(zval* zv) const;
+        void export_objects(zval* zv) const;
+
+        bool enabled() const
+        {
+            return capacity > 0;
+        }
+
+        bool empty() const
+        {
+            return entries.empty();
+        }
+
+        size_t get_size() const
+        {
+            return used;
+        }
+
+    private:
+        struct entry
+        {
+            git_oid oid;
+            git_object_t type;
+            size_t size;
+            bool hasData;
+            std::string data;
+        };
+
+        struct oid_hash
+        {
+            size_t operator()(const git_oid& oid) const
+            {
+                size_t value;
+                memcpy(&value,oid.id,sizeof(value));
+                return value;
+            }
+        };
+
+        struct oid_equal
+        {
+            bool operator()(const git_oid& a,const git_oid& b) const
+            {
+                return git_oid_equal(&a,&b);
+            }
+        };
+
+        using entry_list = std::list<entry>;
+
+        entry* find(const git_oid* oid);
+        void insert(const git_oid* oid,git_object_t type,size_t size,const void* data);
+        void evict(size_t limit);
+
+        static size_t cost(const entry& ent)
+        {
+            return sizeof(entry) + ent.data.size();
+        }
+
+        entry_list entries;
+        std::unordered_map<git_oid,entry_list::iterator,oid_hash,oid_equal> lookup;
+        size_t capacity;
+        size_t used;
+        size_t hits;
+        size_t misses;
+    };
+
+    // Provide an LRU cache of references resolved through a custom refdb
+    // backend, bounded by number of entries. An entry records whether the
+    // reference exists and, once it has been looked up, its target string (an
+    // OID or a symbolic target). Writes going through the backend invalidate
+    // the affected entries.
+
+    class php_refdb_backend_cache
+    {
+    public:
+        php_refdb_backend_cache();
+
+        const char* lookup(const char* refName);
+        bool exists(int* result,const char* refName);
+
+        void put(const char* refName,const char* target,size_t length);
+        void put_exists(const char* refName,bool exists);
+        void remove(const char* refName);
+
+        void set_capacity(size_t count);
+        void clear();
+        void get_stats(zval* zv) const;
+
+        bool enabled() const
+        {
+            return capacity > 0;
+        }
+
+    private:
+        struct entry
+        {
+            std::string name;
+            bool exists;
+            bool hasTarget;
+            std::string target;
+        };
+
+        using entry_list = std::list<entry>;
+
+        entry* find(const char* refName);
+        entry* insert(const char* refName);
+
+        entry_list entries;
+        std::unordered_map<std::string,entry_list::iterator> lookupTable;
+        size_t capacity;
+        size_t hits;
+        size_t misses;
+    };
+
+    // Provide an in-memory copy of the entries of a custom config backend. The
+    // copy is loaded with a single pass of the userspace iterator and serves
+    // lookups and iteration until a write invalidates it.
+
+    class php_config_backend_cache
+    {
+    public:
+        struct entry
+        {
+            std::string name;
+            std::string value;
+            git_config_level_t level;
+        };
+
+        using entry_list = std::vector<entry>;
+
+        php_config_backend_cache();
+
+        const entry* find(const char* name);
+        void assign(std::shared_ptr<const entry_list> newEntries);
+        void invalidate();
+
+        void set_enabled(bool enable);
+        void get_stats(zval* zv) const;
+
+        bool enabled() const
+        {
+            return isEnabled;
+        }
+
+        bool loaded() const
+        {
+            return entries != nullptr;
+        }
+
+        std::shared_ptr<const entry_list> get_entries() const
+        {
+            return entries;
+        }
+
+    private:
+        std::shared_ptr<const entry_list> entries;
+        std::unordered_map<std::string,size_t> lookup;
+        bool isEnabled;
+        size_t loads;
+        size_t hits;
+        size_t misses;
+    };
+
     // Define custom storage types for custom classes.
 
     struct php_odb_backend_object
@@ -233,6 +425,10 @@ namespace php_git2
         git_odb_backend* backend;
         backend_kind kind;
         php_git_odb* owner;
+        php_odb_backend_cache cache;
+        php_odb_backend_cache prefetch;
+        php_odb_backend_cache pending;
+        bool batchOpen;
 
         void create_custom_backend(zval* obj);
         void create_conventional_backend(php_git_odb* newOwner)
@@ -248,6 +444,10 @@ namespace php_git2
             return php_git2_odb_backend_obj;
         }
 
+        // Passes buffered writes to write_batch() and calls end_batch().
+        static int close_batch(git_odb_backend* backend);
+        static int close_batch_callback(void* payload);
+
     private:
         // Provide a custom odb_backend derivation that remembers the PHP object
         // to which it's attached.
@@ -276,6 +476,18 @@ namespace php_git2
             git_odb_backend* backend,
             const git_oid* oid);
 
+        // Calls begin_batch() and defers closing the batch until the
+        // outermost call into libgit2 returns.
+        static int open_batch(git_odb_backend* backend);
+
+        // Calls read_many() for objects that are likely to be read next (i.e.
+        // subtrees of a tree and parents of a commit) and stores the results
+        // in the prefetch buffer.
+        static int prefetch_related(git_odb_backend* backend,
+            git_object_t type,
+            const void* data,
+            size_t size);
+
         static int read_prefix(git_oid* oidp,
             void** bufferp,
             size_t* sizep,
@@ -488,6 +700,7 @@ namespace php_git2
 
         git_config_backend* backend;
         php_git_config* owner;
+        php_config_backend_cache cache;
 
         void create_custom_backend(zval* zobj,php_git_config* owner);
 
@@ -542,6 +755,11 @@ namespace php_git2
         static int unlock(git_config_backend* cfg,int success);
 
         static void free(git_config_backend* cfg);
+
+        // Helpers for the cached mode.
+
+        static int userspace_iterator(git_config_iterator** iter,git_config_backend* cfg);
+        static int load_cache(git_config_backend* cfg);
     };
 
     struct php_refdb_backend_object
@@ -560,6 +778,7 @@ namespace php_git2
         git_refdb_backend* backend;
         backend_kind kind;
         php_git_refdb* owner;
+        php_refdb_backend_cache cache;
 
         void create_custom_backend(zval* zobj);
         void create_conventional_backend(php_git_refdb* newOwner)
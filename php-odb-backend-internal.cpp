@@ -165,7 +165,7 @@ PHP_METHOD(GitODBBackend_Internal,read)
     // then call read().
     try {
         int retval;
-        convert_oid_fromstr(&oid,strOid,strOidLen);
+        convert_oid_fromhex(&oid,strOid,strOidLen);
         retval = object->backend->read(&data,&size,&type,object->backend,&oid);
         if (retval < 0) {
             php_git2::git_error(retval);
@@ -229,7 +229,7 @@ PHP_METHOD(GitODBBackend_Internal,read_prefix)
     // then call read_prefix().
     try {
         int retval;
-        convert_oid_fromstr(&prefix,strOid,strOidLen);
+        convert_oid_fromhex(&prefix,strOid,strOidLen);
         retval = object->backend->read_prefix(
             &full,
             &data,
@@ -247,7 +247,7 @@ PHP_METHOD(GitODBBackend_Internal,read_prefix)
             // parameters. Finally we have to free the buffer allocated by the
             // call to read_prefix().
             RETVAL_STRINGL((const char*)data,size);
-            convert_oid(zoid,&full);
+            convert_oid_hex(zoid,&full);
             ZVAL_LONG(ztype,type);
             free(data);
         }
@@ -301,7 +301,7 @@ PHP_METHOD(GitODBBackend_Internal,read_header)
     // and then call read().
     try {
         int retval;
-        convert_oid_fromstr(&oid,strOid,strOidLen);
+        convert_oid_fromhex(&oid,strOid,strOidLen);
         retval = object->backend->read_header(&size,&type,object->backend,&oid);
         if (retval < 0) {
             php_git2::git_error(retval);
@@ -357,7 +357,7 @@ PHP_METHOD(GitODBBackend_Internal,write)
     // Convert OID hex string to oid structure and call underlying function.
     try {
         int retval;
-        convert_oid_fromstr(&oid,uoid,uoidSize);
+        convert_oid_fromhex(&oid,uoid,uoidSize);
         retval = object->backend->write(object->backend,&oid,data,dataSize,(git_object_t)type);
         if (retval < 0) {
             php_git2::git_error(retval);
@@ -456,7 +456,7 @@ PHP_METHOD(GitODBBackend_Internal,readstream)
         size_t outsize = 0;
         git_object_t outtype = GIT_OBJ_ANY;
 
-        convert_oid_fromstr(&oid,oidstr,oidstr_len);
+        convert_oid_fromhex(&oid,oidstr,oidstr_len);
 
         retval = object->backend->readstream(
             &outstream,
@@ -508,7 +508,7 @@ PHP_METHOD(GitODBBackend_Internal,exists)
     }
 
     // Convert OID hex string to oid structure.
-    convert_oid_fromstr(&oid,uoid,uoidSize);
+    convert_oid_fromhex(&oid,uoid,uoidSize);
 
     // Call underlying function.
     try {
@@ -561,7 +561,7 @@ PHP_METHOD(GitODBBackend_Internal,exists_prefix)
     }
 
     // Convert OID hex string to oid structure.
-    convert_oid_fromstr(&oid,uoid,uoidSize);
+    convert_oid_fromhex(&oid,uoid,uoidSize);
 
     // Call underlying function.
     try {
@@ -583,7 +583,7 @@ PHP_METHOD(GitODBBackend_Internal,exists_prefix)
     // Confusingly, the exists_prefix() function returns 0 if found.
     if (retval == 0) {
         // Set the out variable to the full OID string.
-        convert_oid(zoid,&fullOid);
+        convert_oid_hex(zoid,&fullOid);
 
         RETURN_TRUE;
     }
@@ -0,0 +1,540 @@
+/*
+ * php-odb-backend-sqlite.cpp
+ *
+ * Copyright (C) Roger P. Gee
+ *
+ * This unit provides a native git_odb_backend that stores objects in a SQLite
+ * database. It is only built when the extension is configured with
+ * --with-git2-sqlite.
+ */
+
+#include "php-git2.h"
+
+#ifdef HAVE_GIT2_SQLITE
+
+#include <sqlite3.h>
+extern "C" {
+#include <git2/sys/odb_backend.h>
+}
+using namespace php_git2;
+
+enum sqlite_statement
+{
+    stmt_read,
+    stmt_read_header,
+    stmt_read_prefix,
+    stmt_exists,
+    stmt_write,
+    stmt_list,
+    stmt_begin,
+    stmt_commit,
+    stmt_rollback,
+    _stmt_top_
+};
+
+static const char* const SQLITE_STATEMENTS[] = {
+    "SELECT type,data FROM odb WHERE oid = ?1",
+    "SELECT type,size FROM odb WHERE oid = ?1",
+    "SELECT oid,type,data FROM odb WHERE oid BETWEEN ?1 AND ?2 LIMIT 2",
+    "SELECT 1 FROM odb WHERE oid = ?1",
+    "INSERT OR IGNORE INTO odb (oid,type,size,data) VALUES (?1,?2,?3,?4)",
+    "SELECT oid FROM odb",
+    "BEGIN",
+    "COMMIT",
+    "ROLLBACK"
+};
+
+static const char SQLITE_SCHEMA[] =
+    "PRAGMA journal_mode=WAL;"
+    "PRAGMA synchronous=NORMAL;"
+    "CREATE TABLE IF NOT EXISTS odb ("
+    "  oid BLOB PRIMARY KEY NOT NULL,"
+    "  type INTEGER NOT NULL,"
+    "  size INTEGER NOT NULL,"
+    "  data BLOB NOT NULL"
+    ") WITHOUT ROWID;";
+
+struct git_odb_backend_sqlite:
+    git_odb_backend
+{
+    sqlite3* db;
+    sqlite3_stmt* stmt[_stmt_top_];
+    bool transaction;
+};
+
+static inline git_odb_backend_sqlite* get_sqlite(git_odb_backend* backend)
+{
+    return static_cast<git_odb_backend_sqlite*>(backend);
+}
+
+static int sqlite_error(git_odb_backend_sqlite* backend)
+{
+    giterr_set_str(GITERR_ODB,sqlite3_errmsg(backend->db));
+    return GIT_ERROR;
+}
+
+static int sqlite_notfound()
+{
+    giterr_set_str(GITERR_ODB,"Object not found in SQLite backend");
+    return GIT_ENOTFOUND;
+}
+
+// Computes the inclusive range of raw OIDs that match an abbreviated OID of
+// 'len' hex digits.
+
+static void sqlite_prefix_range(unsigned char* lo,
+    unsigned char* hi,
+    const git_oid* prefix,
+    size_t len)
+{
+    size_t n = len / 2;
+
+    memcpy(lo,prefix->id,n);
+    memcpy(hi,prefix->id,n);
+    memset(lo + n,0x00,GIT_OID_RAWSZ - n);
+    memset(hi + n,0xff,GIT_OID_RAWSZ - n);
+
+    if (len % 2 == 1) {
+        lo[n] = prefix->id[n] & 0xf0;
+        hi[n] = prefix->id[n] | 0x0f;
+    }
+}
+
+// Copies the object data in column 'col' into a buffer that git2 frees later
+// on.
+
+static int sqlite_copy_data(void** bufferp,
+    size_t* sizep,
+    git_odb_backend* backend,
+    sqlite3_stmt* stmt,
+    int col)
+{
+    size_t size = static_cast<size_t>(sqlite3_column_bytes(stmt,col));
+    void* data = git_odb_backend_data_alloc(backend,size);
+
+    if (data == nullptr) {
+        return GIT_ERROR;
+    }
+
+    if (size > 0) {
+        memcpy(data,sqlite3_column_blob(stmt,col),size);
+    }
+
+    *bufferp = data;
+    *sizep = size;
+
+    return GIT_OK;
+}
+
+static int sqlite_exec(git_odb_backend_sqlite* backend,sqlite_statement which)
+{
+    sqlite3_stmt* stmt = backend->stmt[which];
+    int rc;
+
+    rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+
+    return rc;
+}
+
+// Rolls back the open transaction after a failure. SQLite may already have
+// rolled it back on its own, in which case the connection is in autocommit
+// mode again.
+
+static void sqlite_rollback(git_odb_backend_sqlite* backend)
+{
+    if (!sqlite3_get_autocommit(backend->db)) {
+        sqlite_exec(backend,stmt_rollback);
+    }
+
+    backend->transaction = false;
+}
+
+static int sqlite_commit(git_odb_backend_sqlite* backend)
+{
+    int result;
+
+    if (!backend->transaction) {
+        return GIT_OK;
+    }
+
+    if (sqlite_exec(backend,stmt_commit) != SQLITE_DONE) {
+        result = sqlite_error(backend);
+        sqlite_rollback(backend);
+        return result;
+    }
+
+    backend->transaction = false;
+    return GIT_OK;
+}
+
+static int sqlite_commit_callback(void* payload)
+{
+    return sqlite_commit(reinterpret_cast<git_odb_backend_sqlite*>(payload));
+}
+
+static int sqlite_read(void** bufferp,
+    size_t* sizep,
+    git_object_t* typep,
+    git_odb_backend* backend,
+    const git_oid* oid)
+{
+    git_odb_backend_sqlite* sqlite = get_sqlite(backend);
+    sqlite3_stmt* stmt = sqlite->stmt[stmt_read];
+    int result;
+    int rc;
+
+    sqlite3_bind_blob(stmt,1,oid->id,GIT_OID_RAWSZ,SQLITE_STATIC);
+
+    rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        *typep = static_cast<git_object_t>(sqlite3_column_int(stmt,0));
+        result = sqlite_copy_data(bufferp,sizep,backend,stmt,1);
+    }
+    else if (rc == SQLITE_DONE) {
+        result = sqlite_notfound();
+    }
+    else {
+        result = sqlite_error(sqlite);
+    }
+
+    sqlite3_reset(stmt);
+
+    return result;
+}
+
+static int sqlite_read_header(size_t* sizep,
+    git_object_t* typep,
+    git_odb_backend* backend,
+    const git_oid* oid)
+{
+    git_odb_backend_sqlite* sqlite = get_sqlite(backend);
+    sqlite3_stmt* stmt = sqlite->stmt[stmt_read_header];
+    int result;
+    int rc;
+
+    sqlite3_bind_blob(stmt,1,oid->id,GIT_OID_RAWSZ,SQLITE_STATIC);
+
+    rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        *typep = static_cast<git_object_t>(sqlite3_column_int(stmt,0));
+        *sizep = static_cast<size_t>(sqlite3_column_int64(stmt,1));
+        result = GIT_OK;
+    }
+    else if (rc == SQLITE_DONE) {
+        result = sqlite_notfound();
+    }
+    else {
+        result = sqlite_error(sqlite);
+    }
+
+    sqlite3_reset(stmt);
+
+    return result;
+}
+
+static int sqlite_read_prefix(git_oid* oidp,
+    void** bufferp,
+    size_t* sizep,
+    git_object_t* typep,
+    git_odb_backend* backend,
+    const git_oid* prefix,
+    size_t len)
+{
+    git_odb_backend_sqlite* sqlite = get_sqlite(backend);
+    sqlite3_stmt* stmt = sqlite->stmt[stmt_read_prefix];
+    unsigned char lo[GIT_OID_RAWSZ];
+    unsigned char hi[GIT_OID_RAWSZ];
+    int result;
+    int rc;
+
+    if (len >= GIT_OID_HEXSZ) {
+        result = sqlite_read(bufferp,sizep,typep,backend,prefix);
+        if (result == GIT_OK) {
+            git_oid_cpy(oidp,prefix);
+        }
+        return result;
+    }
+
+    // The primary key index turns the prefix into a range scan. We fetch at
+    // most two rows to detect ambiguity.
+
+    sqlite_prefix_range(lo,hi,prefix,len);
+    sqlite3_bind_blob(stmt,1,lo,GIT_OID_RAWSZ,SQLITE_STATIC);
+    sqlite3_bind_blob(stmt,2,hi,GIT_OID_RAWSZ,SQLITE_STATIC);
+
+    rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        git_oid_fromraw(oidp,reinterpret_cast<const unsigned char*>(sqlite3_column_blob(stmt,0)));
+        *typep = static_cast<git_object_t>(sqlite3_column_int(stmt,1));
+        result = sqlite_copy_data(bufferp,sizep,backend,stmt,2);
+
+        if (result == GIT_OK) {
+            rc = sqlite3_step(stmt);
+            if (rc == SQLITE_ROW) {
+                git_odb_backend_data_free(backend,*bufferp);
+                giterr_set_str(GITERR_ODB,"Ambiguous object prefix in SQLite backend");
+                result = GIT_EAMBIGUOUS;
+            }
+            else if (rc != SQLITE_DONE) {
+                git_odb_backend_data_free(backend,*bufferp);
+                result = sqlite_error(sqlite);
+            }
+        }
+    }
+    else if (rc == SQLITE_DONE) {
+        result = sqlite_notfound();
+    }
+    else {
+        result = sqlite_error(sqlite);
+    }
+
+    sqlite3_reset(stmt);
+
+    return result;
+}
+
+static int sqlite_write(git_odb_backend* backend,
+    const git_oid* oid,
+    const void* data,
+    size_t size,
+    git_object_t type)
+{
+    git_odb_backend_sqlite* sqlite = get_sqlite(backend);
+    sqlite3_stmt* stmt = sqlite->stmt[stmt_write];
+    int result;
+    int rc;
+
+    // Writes made during a call into libgit2 share one transaction that is
+    // committed when the outermost call returns. Reads on the same connection
+    // see uncommitted objects.
+
+    if (!sqlite->transaction) {
+        if (sqlite_exec(sqlite,stmt_begin) != SQLITE_DONE) {
+            return sqlite_error(sqlite);
+        }
+
+        sqlite->transaction = true;
+    }
+
+    sqlite3_bind_blob(stmt,1,oid->id,GIT_OID_RAWSZ,SQLITE_STATIC);
+    sqlite3_bind_int(stmt,2,static_cast<int>(type));
+    sqlite3_bind_int64(stmt,3,static_cast<sqlite3_int64>(size));
+    sqlite3_bind_blob64(stmt,4,data,static_cast<sqlite3_uint64>(size),SQLITE_STATIC);
+
+    rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+
+    if (rc != SQLITE_DONE) {
+        result = sqlite_error(sqlite);
+        php_git2_write_scope_cancel(sqlite);
+        sqlite_rollback(sqlite);
+        return result;
+    }
+
+    // A write that happens outside of any tracked call is committed
+    // immediately.
+
+    if (!php_git2_write_scope_active()) {
+        return sqlite_commit(sqlite);
+    }
+
+    php_git2_write_scope_defer(sqlite_commit_callback,sqlite);
+
+    return GIT_OK;
+}
+
+static int sqlite_exists(git_odb_backend* backend,const git_oid* oid)
+{
+    git_odb_backend_sqlite* sqlite = get_sqlite(backend);
+    sqlite3_stmt* stmt = sqlite->stmt[stmt_exists];
+    int result;
+    int rc;
+
+    sqlite3_bind_blob(stmt,1,oid->id,GIT_OID_RAWSZ,SQLITE_STATIC);
+
+    rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        result = 1;
+    }
+    else if (rc == SQLITE_DONE) {
+        result = 0;
+    }
+    else {
+        result = sqlite_error(sqlite);
+    }
+
+    sqlite3_reset(stmt);
+
+    return result;
+}
+
+static int sqlite_exists_prefix(git_oid* oidp,
+    git_odb_backend* backend,
+    const git_oid* prefix,
+    size_t len)
+{
+    git_odb_backend_sqlite* sqlite = get_sqlite(backend);
+    sqlite3_stmt* stmt = sqlite->stmt[stmt_read_prefix];
+    unsigned char lo[GIT_OID_RAWSZ];
+    unsigned char hi[GIT_OID_RAWSZ];
+    int result;
+    int rc;
+
+    sqlite_prefix_range(lo,hi,prefix,len);
+    sqlite3_bind_blob(stmt,1,lo,GIT_OID_RAWSZ,SQLITE_STATIC);
+    sqlite3_bind_blob(stmt,2,hi,GIT_OID_RAWSZ,SQLITE_STATIC);
+
+    rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        git_oid_fromraw(oidp,reinterpret_cast<const unsigned char*>(sqlite3_column_blob(stmt,0)));
+
+        rc = sqlite3_step(stmt);
+        if (rc == SQLITE_ROW) {
+            giterr_set_str(GITERR_ODB,"Ambiguous object prefix in SQLite backend");
+            result = GIT_EAMBIGUOUS;
+        }
+        else if (rc == SQLITE_DONE) {
+            result = GIT_OK;
+        }
+        else {
+            result = sqlite_error(sqlite);
+        }
+    }
+    else if (rc == SQLITE_DONE) {
+        result = sqlite_notfound();
+    }
+    else {
+        result = sqlite_error(sqlite);
+    }
+
+    sqlite3_reset(stmt);
+
+    return result;
+}
+
+static int sqlite_foreach(git_odb_backend* backend,git_odb_foreach_cb cb,void* payload)
+{
+    git_odb_backend_sqlite* sqlite = get_sqlite(backend);
+    sqlite3_stmt* stmt = sqlite->stmt[stmt_list];
+    int result = GIT_OK;
+    int rc;
+
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        git_oid oid;
+
+        git_oid_fromraw(&oid,reinterpret_cast<const unsigned char*>(sqlite3_column_blob(stmt,0)));
+
+        result = cb(&oid,payload);
+        if (result != 0) {
+            break;
+        }
+    }
+
+    if (rc != SQLITE_ROW && rc != SQLITE_DONE) {
+        result = sqlite_error(sqlite);
+    }
+
+    sqlite3_reset(stmt);
+
+    return result;
+}
+
+static void sqlite_free(git_odb_backend* backend)
+{
+    git_odb_backend_sqlite* sqlite = get_sqlite(backend);
+
+    php_git2_write_scope_cancel(sqlite);
+
+    if (sqlite->db != nullptr) {
+        // The transaction is normally committed before the backend is freed.
+        // A failure here can only be reported as a warning.
+
+        if (sqlite_commit(sqlite) != GIT_OK && GIT2_G(requestActive)) {
+            const git_error* err = giterr_last();
+
+            php_error_docref(nullptr,
+                E_WARNING,
+                "Failed to commit SQLite ODB backend transaction: %s",
+                err != nullptr ? err->message : "unknown error");
+        }
+
+        for (int i = 0;i < _stmt_top_;++i) {
+            sqlite3_finalize(sqlite->stmt[i]);
+        }
+
+        sqlite3_close(sqlite->db);
+    }
+
+    // NOTE: The backend is allocated with the C allocator since libgit2 may
+    // free it after the request ends (e.g. when it is attached to a persistent
+    // repository).
+    free(sqlite);
+}
+
+int php_git2::php_git2_odb_backend_sqlite(git_odb_backend** out,
+    const char* path,
+    int busyTimeout)
+{
+    git_odb_backend_sqlite* sqlite;
+    int rc;
+
+    sqlite = reinterpret_cast<git_odb_backend_sqlite*>(calloc(1,sizeof(git_odb_backend_sqlite)));
+    if (sqlite == nullptr) {
+        giterr_set_str(GITERR_NOMEMORY,"Out of memory");
+        return GIT_ERROR;
+    }
+
+    git_odb_init_backend(sqlite,GIT_ODB_BACKEND_VERSION);
+    sqlite->read = sqlite_read;
+    sqlite->read_header = sqlite_read_header;
+    sqlite->read_prefix = sqlite_read_prefix;
+    sqlite->write = sqlite_write;
+    sqlite->exists = sqlite_exists;
+    sqlite->exists_prefix = sqlite_exists_prefix;
+    sqlite->foreach = sqlite_foreach;
+    sqlite->free = sqlite_free;
+
+    rc = sqlite3_open_v2(path,
+        &sqlite->db,
+        SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE,
+        nullptr);
+    if (rc == SQLITE_OK) {
+        // Wait for locks held by other connections (e.g. another PHP process
+        // committing) instead of failing with SQLITE_BUSY right away.
+        rc = sqlite3_busy_timeout(sqlite->db,busyTimeout);
+    }
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_exec(sqlite->db,SQLITE_SCHEMA,nullptr,nullptr,nullptr);
+    }
+
+    for (int i = 0;rc == SQLITE_OK && i < _stmt_top_;++i) {
+        rc = sqlite3_prepare_v2(sqlite->db,SQLITE_STATEMENTS[i],-1,&sqlite->stmt[i],nullptr);
+    }
+
+    if (rc != SQLITE_OK) {
+        if (sqlite->db != nullptr) {
+            sqlite_error(sqlite);
+        }
+        else {
+            giterr_set_str(GITERR_NOMEMORY,"Out of memory");
+        }
+
+        sqlite_free(sqlite);
+        return GIT_ERROR;
+    }
+
+    *out = sqlite;
+
+    return GIT_OK;
+}
+
+#endif
+
+/*
+ * Local Variables:
+ * mode:c++
+ * indent-tabs-mode:nil
+ * tab-width:4
+ * End:
+ */
@@ -11,8 +11,20 @@
 #include "php-callback.h"
 #include <cstring>
 #include <new>
+#include <vector>
+#include <algorithm>
+#include <limits>
 using namespace php_git2;
 
+// Size of the buffer holding objects returned by read_many() and the number of
+// rounds of related objects fetched for a single read.
+static constexpr size_t PREFETCH_BUFFER_SIZE = 8 * 1024 * 1024;
+static constexpr unsigned PREFETCH_MAX_ROUNDS = 4;
+
+// Write batches for backends that implement write_batch() are closed early
+// once their buffered objects exceed this many bytes.
+static constexpr size_t WRITE_BUFFER_SIZE = 16 * 1024 * 1024;
+
 // Wrapper for efree since it's a macro.
 
 static void efree_wrapper(void* d)
@@ -20,6 +32,51 @@ static void efree_wrapper(void* d)
     efree(d);
 }
 
+// Helpers for finding objects related to a raw tree or commit.
+
+static void collect_subtrees(std::vector<git_oid>& out,const char* p,const char* end)
+{
+    // Each tree entry is "<mode> <name>\0<raw-oid>". Subtrees have mode 40000.
+
+    while (p < end) {
+        const char* nul = reinterpret_cast<const char*>(memchr(p,'\0',end - p));
+        if (nul == nullptr || end - (nul + 1) < GIT_OID_RAWSZ) {
+            break;
+        }
+
+        if (nul - p > 6 && memcmp(p,"40000 ",6) == 0) {
+            git_oid oid;
+            git_oid_fromraw(&oid,reinterpret_cast<const unsigned char*>(nul + 1));
+            out.push_back(oid);
+        }
+
+        p = nul + 1 + GIT_OID_RAWSZ;
+    }
+}
+
+static void collect_parents(std::vector<git_oid>& out,const char* p,const char* end)
+{
+    // A commit starts with "tree <hex>\n" followed by zero or more
+    // "parent <hex>\n" lines.
+
+    const size_t treeLen = sizeof("tree ")-1 + GIT_OID_HEXSZ + 1;
+    const size_t parentLen = sizeof("parent ")-1 + GIT_OID_HEXSZ + 1;
+
+    if (static_cast<size_t>(end - p) < treeLen || memcmp(p,"tree ",5) != 0) {
+        return;
+    }
+    p += treeLen;
+
+    while (static_cast<size_t>(end - p) >= parentLen && memcmp(p,"parent ",7) == 0) {
+        git_oid oid;
+
+        if (git_oid_fromstrn(&oid,p + 7,GIT_OID_HEXSZ) == 0) {
+            out.push_back(oid);
+        }
+        p += parentLen;
+    }
+}
+
 // Custom class handlers
 
 static zval* odb_backend_read_property(zval* object,
@@ -72,6 +129,10 @@ static PHP_EMPTY_METHOD(GitODBBackend,exists);
 static PHP_EMPTY_METHOD(GitODBBackend,exists_prefix);
 static PHP_EMPTY_METHOD(GitODBBackend,refresh);
 static PHP_EMPTY_METHOD(GitODBBackend,writepack);
+static PHP_EMPTY_METHOD(GitODBBackend,read_many);
+static PHP_EMPTY_METHOD(GitODBBackend,begin_batch);
+static PHP_EMPTY_METHOD(GitODBBackend,write_batch);
+static PHP_EMPTY_METHOD(GitODBBackend,end_batch);
 
 zend_function_entry php_git2::odb_backend_methods[] = {
     PHP_ME(GitODBBackend,read,NULL,ZEND_ACC_PUBLIC)
@@ -85,6 +146,10 @@ zend_function_entry php_git2::odb_backend_methods[] = {
     PHP_ME(GitODBBackend,refresh,NULL,ZEND_ACC_PUBLIC)
     PHP_ABSTRACT_ME(GitODBBackend,for_each,NULL)
     PHP_ME(GitODBBackend,writepack,NULL,ZEND_ACC_PUBLIC)
+    PHP_ME(GitODBBackend,read_many,NULL,ZEND_ACC_PUBLIC)
+    PHP_ME(GitODBBackend,begin_batch,NULL,ZEND_ACC_PUBLIC)
+    PHP_ME(GitODBBackend,write_batch,NULL,ZEND_ACC_PUBLIC)
+    PHP_ME(GitODBBackend,end_batch,NULL,ZEND_ACC_PUBLIC)
     PHP_FE_END
 };
 
@@ -105,10 +170,255 @@ void php_zend_object<php_odb_backend_object>::init(zend_class_entry* ce)
     UNUSED(ce);
 }
 
+// Implementation of php_odb_backend_cache
+
+php_odb_backend_cache::php_odb_backend_cache():
+    capacity(0), used(0), hits(0), misses(0)
+{
+}
+
+bool php_odb_backend_cache::read(
+    void** bufferp,
+    size_t* sizep,
+    git_object_t* typep,
+    git_odb_backend* backend,
+    const git_oid* oid)
+{
+    if (!enabled()) {
+        return false;
+    }
+
+    entry* ent = find(oid);
+
+    if (ent == nullptr || !ent->hasData) {
+        misses += 1;
+        return false;
+    }
+
+    // Copy the data to a buffer that git2 can free later on.
+    void* data = git_odb_backend_data_alloc(backend,ent->data.size());
+    if (data == nullptr) {
+        return false;
+    }
+    memcpy(data,ent->data.data(),ent->data.size());
+
+    *bufferp = data;
+    *sizep = ent->data.size();
+    *typep = ent->type;
+    hits += 1;
+
+    return true;
+}
+
+bool php_odb_backend_cache::read_header(
+    size_t* sizep,
+    git_object_t* typep,
+    const git_oid* oid)
+{
+    if (!enabled()) {
+        return false;
+    }
+
+    entry* ent = find(oid);
+
+    if (ent == nullptr) {
+        misses += 1;
+        return false;
+    }
+
+    *sizep = ent->size;
+    *typep = ent->type;
+    hits += 1;
+
+    return true;
+}
+
+bool php_odb_backend_cache::exists(const git_oid* oid)
+{
+    // NOTE: Only objects that were found are cached, so a miss must always be
+    // forwarded to the backend.
+
+    if (!enabled()) {
+        return false;
+    }
+
+    if (find(oid) == nullptr) {
+        misses += 1;
+        return false;
+    }
+
+    hits += 1;
+    return true;
+}
+
+bool php_odb_backend_cache::contains(const git_oid* oid) const
+{
+    return lookup.find(*oid) != lookup.end();
+}
+
+void php_odb_backend_cache::put(
+    const git_oid* oid,
+    const void* data,
+    size_t size,
+    git_object_t type)
+{
+    if (!enabled()) {
+        return;
+    }
+
+    entry* ent = find(oid);
+    if (ent != nullptr && ent->hasData) {
+        return;
+    }
+
+    insert(oid,type,size,data);
+}
+
+void php_odb_backend_cache::put_header(
+    const git_oid* oid,
+    size_t size,
+    git_object_t type)
+{
+    if (!enabled() || find(oid) != nullptr) {
+        return;
+    }
+
+    insert(oid,type,size,nullptr);
+}
+
+void php_odb_backend_cache::remove(const git_oid* oid)
+{
+    auto iter = lookup.find(*oid);
+
+    if (iter != lookup.end()) {
+        used -= cost(*iter->second);
+        entries.erase(iter->second);
+        lookup.erase(iter);
+    }
+}
+
+void php_odb_backend_cache::export_objects(zval* zv) const
+{
+    array_init_size(zv,entries.size());
+
+    // Export the oldest entries first so that objects appear roughly in the
+    // order they were added.
+
+    for (auto iter = entries.rbegin();iter != entries.rend();++iter) {
+        char buf[GIT_OID_HEXSZ + 1];
+        zval zentry;
+
+        if (!iter->hasData) {
+            continue;
+        }
+
+        git_oid_tostr(buf,sizeof(buf),&iter->oid);
+
+        array_init_size(&zentry,2);
+        add_assoc_long_ex(&zentry,"type",sizeof("type")-1,iter->type);
+        add_assoc_stringl_ex(&zentry,
+            "data",
+            sizeof("data")-1,
+            iter->data.data(),
+            iter->data.size());
+
+        add_assoc_zval_ex(zv,buf,GIT_OID_HEXSZ,&zentry);
+    }
+}
+
+void php_odb_backend_cache::set_capacity(size_t bytes)
+{
+    capacity = bytes;
+    evict(capacity);
+}
+
+void php_odb_backend_cache::clear()
+{
+    entries.clear();
+    lookup.clear();
+    used = 0;
+}
+
+void php_odb_backend_cache::get_stats(zval* zv) const
+{
+    array_init_size(zv,5);
+    add_assoc_long_ex(zv,"capacity",sizeof("capacity")-1,static_cast<zend_long>(capacity));
+    add_assoc_long_ex(zv,"bytes",sizeof("bytes")-1,static_cast<zend_long>(used));
+    add_assoc_long_ex(zv,"entries",sizeof("entries")-1,static_cast<zend_long>(entries.size()));
+    add_assoc_long_ex(zv,"hits",sizeof("hits")-1,static_cast<zend_long>(hits));
+    add_assoc_long_ex(zv,"misses",sizeof("misses")-1,static_cast<zend_long>(misses));
+}
+
+php_odb_backend_cache::entry* php_odb_backend_cache::find(const git_oid* oid)
+{
+    if (!enabled()) {
+        return nullptr;
+    }
+
+    auto iter = lookup.find(*oid);
+    if (iter == lookup.end()) {
+        return nullptr;
+    }
+
+    // Move the entry to the front of the list since it is now the most
+    // recently used.
+    entries.splice(entries.begin(),entries,iter->second);
+
+    return &*iter->second;
+}
+
+void php_odb_backend_cache::insert(
+    const git_oid* oid,
+    git_object_t type,
+    size_t size,
+    const void* data)
+{
+    auto iter = lookup.find(*oid);
+
+    // Replace an existing (header-only) entry.
+    if (iter != lookup.end()) {
+        used -= cost(*iter->second);
+        entries.erase(iter->second);
+        lookup.erase(iter);
+    }
+
+    entry ent;
+    git_oid_cpy(&ent.oid,oid);
+    ent.type = type;
+    ent.size = size;
+    ent.hasData = (data != nullptr);
+    if (data != nullptr) {
+        ent.data.assign(reinterpret_cast<const char*>(data),size);
+    }
+
+    // Objects that exceed the entire budget are never cached.
+    if (cost(ent) > capacity) {
+        return;
+    }
+
+    // Make room for the new entry before adding it.
+    evict(capacity - cost(ent));
+
+    used += cost(ent);
+    entries.push_front(std::move(ent));
+    lookup.emplace(*oid,entries.begin());
+}
+
+void php_odb_backend_cache::evict(size_t limit)
+{
+    while (used > limit && !entries.empty()) {
+        const entry& ent = entries.back();
+
+        used -= cost(ent);
+        lookup.erase(ent.oid);
+        entries.pop_back();
+    }
+}
+
 // Implementation of php_odb_backend_object
 
 php_odb_backend_object::php_odb_backend_object():
-    backend(nullptr), kind(unset), owner(nullptr)
+    backend(nullptr), kind(unset), owner(nullptr), batchOpen(false)
 {
 }
 
@@ -146,6 +456,17 @@ void php_odb_backend_object::create_custom_backend(zval* obj)
     backend = new (emalloc(sizeof(git_odb_backend_php)))
         git_odb_backend_php(Z_OBJ_P(obj));
 
+    // Objects are only prefetched for classes that implement read_many().
+    if (is_method_overridden(Z_OBJCE_P(obj),"read_many",sizeof("read_many")-1)) {
+        prefetch.set_capacity(PREFETCH_BUFFER_SIZE);
+    }
+
+    // Writes are only buffered for classes that implement write_batch(). The
+    // buffer itself is unbounded; WRITE_BUFFER_SIZE closes the batch early.
+    if (is_method_overridden(Z_OBJCE_P(obj),"write_batch",sizeof("write_batch")-1)) {
+        pending.set_capacity(std::numeric_limits<size_t>::max());
+    }
+
     // Custom ODB backends never have a direct owner. We always assume the
     // would-be owner is kept alive circularly since the custom backend stores a
     // reference to this object.
@@ -186,13 +507,39 @@ void php_odb_backend_object::unset_backend(zval* obj)
     const git_oid* oid)
 {
     int result;
+    php_odb_backend_object* object = method_wrapper::object_wrapper(backend).backing();
+
+    // Serve the object from the cache if possible. This avoids calling into
+    // userspace altogether.
+    if (object->cache.read(bufferp,sizep,typep,backend,oid)) {
+        return GIT_OK;
+    }
+
+    // Objects waiting to be flushed to write_batch() must be visible.
+    if (object->pending.read(bufferp,sizep,typep,backend,oid)) {
+        return GIT_OK;
+    }
+
+    // Objects prefetched by read_many() are moved to the cache when consumed.
+    if (object->prefetch.read(bufferp,sizep,typep,backend,oid)) {
+        object->prefetch.remove(oid);
+        object->cache.put(oid,*bufferp,*sizep,*typep);
+
+        result = prefetch_related(backend,*typep,*bufferp,*sizep);
+        if (result < 0) {
+            git_odb_backend_data_free(backend,*bufferp);
+        }
+
+        return result;
+    }
+
     zval_array<2> params;
     method_wrapper method("read",backend);
 
     // Prepare parameters.
 
     params.make_ref(0);
-    convert_oid(params[1],oid);
+    convert_oid_hex(params[1],oid);
 
     // Call userspace method.
 
@@ -222,11 +569,222 @@ void php_odb_backend_object::unset_backend(zval* obj)
         convert_to_long(params[0]);
 
         *typep = (git_object_t)Z_LVAL_P(params[0]);
+
+        object->cache.put(oid,data,datalen,*typep);
+
+        result = prefetch_related(backend,*typep,data,datalen);
+        if (result < 0) {
+            git_odb_backend_data_free(backend,data);
+        }
     }
 
     return result;
 }
 
+/*static*/ int php_odb_backend_object::open_batch(git_odb_backend* backend)
+{
+    int result;
+    php_odb_backend_object* object = method_wrapper::object_wrapper(backend).backing();
+    method_wrapper method("begin_batch",backend);
+
+    result = method.call();
+    if (result == GIT_OK) {
+        object->batchOpen = true;
+        if (php_git2_write_scope_active()) {
+            php_git2_write_scope_defer(close_batch_callback,backend);
+        }
+    }
+
+    return result;
+}
+
+/*static*/ int php_odb_backend_object::close_batch(git_odb_backend* backend)
+{
+    int result = GIT_OK;
+    int endResult;
+    php_odb_backend_object* object = method_wrapper::object_wrapper(backend).backing();
+    zval_array<1> params;
+    zend_object* ex;
+
+    object->batchOpen = false;
+    php_git2_write_scope_cancel(backend);
+
+    // Pass the buffered objects to write_batch(). They stay buffered (and
+    // readable) until the batch ends successfully. If the batch fails, they
+    // are passed again with the next batch.
+
+    object->pending.export_objects(params[0]);
+    if (zend_hash_num_elements(Z_ARRVAL_P(params[0])) > 0) {
+        method_wrapper method("write_batch",backend);
+        result = method.call(params);
+    }
+
+    // Always end the batch so the backend can commit or roll back. Any
+    // exception thrown by write_batch() is set aside for the call since
+    // userspace cannot be called while an exception is pending.
+
+    zval_array<1> endParams;
+    method_wrapper endMethod("end_batch",backend);
+
+    ZVAL_BOOL(endParams[0],result == GIT_OK);
+
+    ex = EG(exception);
+    EG(exception) = nullptr;
+    endResult = endMethod.call(endParams);
+    if (ex != nullptr) {
+        if (EG(exception) != nullptr) {
+            zend_exception_set_previous(EG(exception),ex);
+        }
+        else {
+            EG(exception) = ex;
+        }
+    }
+
+    if (result == GIT_OK) {
+        result = endResult;
+    }
+
+    if (result == GIT_OK) {
+        zend_string* key;
+
+        ZEND_HASH_FOREACH_STR_KEY(Z_ARRVAL_P(params[0]),key) {
+            git_oid oid;
+
+            if (key != nullptr
+                && git_oid_fromstrn(&oid,ZSTR_VAL(key),ZSTR_LEN(key)) == 0)
+            {
+                object->pending.remove(&oid);
+            }
+        } ZEND_HASH_FOREACH_END();
+    }
+
+    return result;
+}
+
+/*static*/ int php_odb_backend_object::close_batch_callback(void* payload)
+{
+    return close_batch(reinterpret_cast<git_odb_backend*>(payload));
+}
+
+/*static*/ int php_odb_backend_object::prefetch_related(
+    git_odb_backend* backend,
+    git_object_t type,
+    const void* data,
+    size_t size)
+{
+    php_odb_backend_object* object = method_wrapper::object_wrapper(backend).backing();
+    std::vector<git_oid> pending;
+    std::vector<git_oid> related;
+
+    if (!object->prefetch.enabled()) {
+        return GIT_OK;
+    }
+
+    auto collect = [&](git_object_t t,const char* p,size_t n) {
+        if (t == GIT_OBJECT_TREE) {
+            collect_subtrees(related,p,p + n);
+        }
+        else if (t == GIT_OBJECT_COMMIT) {
+            collect_parents(related,p,p + n);
+        }
+    };
+
+    collect(type,reinterpret_cast<const char*>(data),size);
+
+    // Fetch related objects breadth-first so that each level of a tree (or
+    // each generation of history) costs a single call into userspace.
+
+    for (unsigned round = 0;round < PREFETCH_MAX_ROUNDS;++round) {
+        int result;
+        zend_string* key;
+        zval* zentry;
+
+        // Drop duplicates and objects we already have.
+
+        std::sort(related.begin(),related.end(),[](const git_oid& a,const git_oid& b) {
+            return git_oid_cmp(&a,&b) < 0;
+        });
+        related.erase(std::unique(related.begin(),related.end(),[](const git_oid& a,const git_oid& b) {
+            return git_oid_equal(&a,&b) != 0;
+        }),related.end());
+
+        pending.clear();
+        for (const git_oid& oid : related) {
+            if (!object->cache.contains(&oid) && !object->prefetch.contains(&oid)) {
+                pending.push_back(oid);
+            }
+        }
+        related.clear();
+
+        if (pending.empty()) {
+            break;
+        }
+
+        zval_array<1> params;
+        method_wrapper method("read_many",backend);
+
+        array_init_size(params[0],pending.size());
+        for (const git_oid& oid : pending) {
+            zval zoid;
+
+            convert_oid_hex(&zoid,&oid);
+            add_next_index_zval(params[0],&zoid);
+        }
+
+        // Prefetching is only an optimization, so a failed read_many() must
+        // not fail the read that triggered it. Only a fatal error is passed
+        // on.
+
+        result = method.call(params);
+        if (result != GIT_OK) {
+            if (result != GIT_EPHP_PROP_BAILOUT) {
+                php_exception_wrapper ex;
+
+                if (ex.has_exception()) {
+                    ex.handle();
+                }
+                giterr_clear();
+                result = GIT_OK;
+            }
+
+            return result;
+        }
+
+        if (Z_TYPE_P(method.retval()) != IS_ARRAY) {
+            break;
+        }
+
+        // The result maps OID to an array with 'type' and 'data' keys. Objects
+        // that were not found may be omitted.
+
+        ZEND_HASH_FOREACH_STR_KEY_VAL(Z_ARRVAL_P(method.retval()),key,zentry) {
+            git_oid oid;
+            git_object_t entryType;
+            zval* ztype;
+            zval* zdata;
+
+            if (key == nullptr
+                || Z_TYPE_P(zentry) != IS_ARRAY
+                || convert_oid_fromhex(&oid,ZSTR_VAL(key),ZSTR_LEN(key)) < 0)
+            {
+                continue;
+            }
+
+            ztype = zend_hash_str_find(Z_ARRVAL_P(zentry),"type",sizeof("type")-1);
+            zdata = zend_hash_str_find(Z_ARRVAL_P(zentry),"data",sizeof("data")-1);
+            if (ztype == nullptr || zdata == nullptr || Z_TYPE_P(zdata) != IS_STRING) {
+                continue;
+            }
+
+            entryType = static_cast<git_object_t>(zval_get_long(ztype));
+            object->prefetch.put(&oid,Z_STRVAL_P(zdata),Z_STRLEN_P(zdata),entryType);
+            collect(entryType,Z_STRVAL_P(zdata),Z_STRLEN_P(zdata));
+        } ZEND_HASH_FOREACH_END();
+    }
+
+    return GIT_OK;
+}
+
 /*static*/ int php_odb_backend_object::read_prefix(
     git_oid* oidp,
     void** bufferp,
@@ -275,8 +833,10 @@ void php_odb_backend_object::unset_backend(zval* obj)
         convert_to_string(params[0]);
         convert_to_long(params[1]);
 
-        convert_oid_fromstr(oidp,Z_STRVAL_P(params[0]),Z_STRLEN_P(params[0]));
+        convert_oid_fromhex(oidp,Z_STRVAL_P(params[0]),Z_STRLEN_P(params[0]));
         *typep = (git_object_t)Z_LVAL_P(params[1]);
+
+        method.backing()->cache.put(oidp,data,datalen,*typep);
     }
 
     return result;
@@ -289,6 +849,15 @@ void php_odb_backend_object::unset_backend(zval* obj)
     const git_oid* oid)
 {
     int result;
+    php_odb_backend_object* object = method_wrapper::object_wrapper(backend).backing();
+
+    if (object->cache.read_header(sizep,typep,oid)
+        || object->pending.read_header(sizep,typep,oid)
+        || object->prefetch.read_header(sizep,typep,oid))
+    {
+        return GIT_OK;
+    }
+
     zval_array<3> params;
     method_wrapper method("read_header",backend);
 
@@ -296,7 +865,7 @@ void php_odb_backend_object::unset_backend(zval* obj)
 
     params.make_ref(0);
     params.make_ref(1);
-    convert_oid(params[2],oid);
+    convert_oid_hex(params[2],oid);
 
     // Call userspace method.
 
@@ -313,6 +882,8 @@ void php_odb_backend_object::unset_backend(zval* obj)
         convert_to_long(params[1]);
         *sizep = Z_LVAL_P(params[0]);
         *typep = (git_object_t)Z_LVAL_P(params[1]);
+
+        object->cache.put_header(oid,*sizep,*typep);
     }
 
     return result;
@@ -326,12 +897,39 @@ void php_odb_backend_object::unset_backend(zval* obj)
     git_object_t type)
 {
     int result;
+    php_odb_backend_object* object = method_wrapper::object_wrapper(backend).backing();
+
+    // Backends that implement write_batch() have their writes buffered until
+    // the outermost call into libgit2 returns.
+
+    if (object->pending.enabled()) {
+        if (!object->batchOpen) {
+            result = open_batch(backend);
+            if (result != GIT_OK) {
+                return result;
+            }
+        }
+
+        object->pending.put(oid,data,size,type);
+
+        // A large batch is closed early to bound the buffer. A write that
+        // happens outside of any tracked call is not deferred.
+
+        if (object->pending.get_size() >= WRITE_BUFFER_SIZE
+            || !php_git2_write_scope_active())
+        {
+            return close_batch(backend);
+        }
+
+        return GIT_OK;
+    }
+
     zval_array<3> params;
     method_wrapper method("write",backend);
 
     // Prepare parameters.
 
-    convert_oid(params[0],oid);
+    convert_oid_hex(params[0],oid);
     ZVAL_STRINGL(params[1],(const char*)data,size);
     ZVAL_LONG(params[2],type);
 
@@ -413,7 +1011,7 @@ void php_odb_backend_object::unset_backend(zval* obj)
 
     params.make_ref(0);
     params.make_ref(1);
-    convert_oid(params[2],oid);
+    convert_oid_hex(params[2],oid);
 
     // Call userspace method.
 
@@ -471,12 +1069,22 @@ void php_odb_backend_object::unset_backend(zval* obj)
     const git_oid* oid)
 {
     int result;
+
+    php_odb_backend_object* object = method_wrapper::object_wrapper(backend).backing();
+
+    if (object->cache.exists(oid)
+        || object->pending.contains(oid)
+        || object->prefetch.contains(oid))
+    {
+        return 1;
+    }
+
     zval_array<1> params;
     method_wrapper method("exists",backend);
 
     // Prepare parameters.
 
-    convert_oid(params[0],oid);
+    convert_oid_hex(params[0],oid);
 
     // Call userspace method.
 
@@ -520,7 +1128,7 @@ void php_odb_backend_object::unset_backend(zval* obj)
 
         params.unref(0);
         convert_to_string(params[0]);
-        convert_oid_fromstr(oidp,Z_STRVAL_P(params[0]),Z_STRLEN_P(params[0]));
+        convert_oid_fromhex(oidp,Z_STRVAL_P(params[0]),Z_STRLEN_P(params[0]));
 
         convert_to_boolean(retval);
         result = Z_TYPE_P(retval) == IS_TRUE ? 0 : GIT_ENOTFOUND;
@@ -678,6 +1286,15 @@ void php_odb_backend_object::unset_backend(zval* obj)
     // may have references to git2 objects that reference this PHP object).
 
     if (EG(objects_store).object_buckets != nullptr) {
+        // Flush any writes still buffered for the backend, including those
+        // left over from a failed batch.
+        if (!object.backing()->batchOpen && !object.backing()->pending.empty()) {
+            open_batch(backend);
+        }
+        if (object.backing()->batchOpen) {
+            close_batch(backend);
+        }
+
         // Unassign backend from the object since it is about to get
         // destroyed. This also ensures no references remain to any ODB since
         // the ODB is (presumably) in the process of freeing right now.
@@ -974,7 +1591,7 @@ ZEND_FUNCTION(backend_foreach_callback)
         info = reinterpret_cast<const foreach_callback_info*>(object->payload);
 
         // Convert string representation to git2 OID struct.
-        php_git2::convert_oid_fromstr(&oid,oidS,oidL);
+        php_git2::convert_oid_fromhex(&oid,oidS,oidL);
 
         // Invoke callback. GIT_EUSER value means that the iteration should stop
         // without an exception. We communicate this to userspace by returning
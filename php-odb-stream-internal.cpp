@@ -193,7 +193,7 @@ PHP_METHOD(GitODBStream_Internal,finalize_write)
     }
 
     // Convert OID string to binary structure.
-    convert_oid_fromstr(&oid,input,input_len);
+    convert_oid_fromhex(&oid,input,input_len);
 
     // Call underlying function.
     try {
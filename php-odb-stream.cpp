@@ -203,7 +203,7 @@ void php_odb_stream_object::assign_owner(php_git_odb* newOwner)
 
     // Initialize/set zvals.
 
-    convert_oid(params[0],oid);
+    convert_oid_hex(params[0],oid);
 
     // Call userspace method implementation of corresponding stream operation.
 
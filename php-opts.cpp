@@ -0,0 +1,273 @@
+/*
+ * php-opts.cpp
+ *
+ * Copyright (C) Roger P. Gee
+ */
+
+#include "php-git2.h"
+#ifdef ZTS
+#include <mutex>
+#endif
+using namespace std;
+using namespace php_git2;
+
+// Provide a table of the global libgit2 options managed by the extension. Each
+// option can be configured in php.ini as "git2.<name>" and changed at runtime
+// via git2_opts_set(). libgit2 options are process-wide; runtime changes are
+// reverted to the configured value at the start of the next request.
+
+enum opt_kind
+{
+    opt_size,
+    opt_bool,
+    opt_cache_max_size,
+    opt_cache_object_limit
+};
+
+struct opt_info
+{
+    const char* name;
+    opt_kind kind;
+
+    // The GIT_OPT_* values used to set and get the option. A getter of -1
+    // means libgit2 cannot report the value so we track it ourselves.
+    int setter;
+    int getter;
+
+    // Extra argument for the option (e.g. object type for cache limits).
+    int arg;
+
+    // The libgit2 default used for options that cannot be queried.
+    zend_long defaultValue;
+};
+
+static const opt_info OPTS[] = {
+    { "mwindow_size", opt_size,
+      GIT_OPT_SET_MWINDOW_SIZE, GIT_OPT_GET_MWINDOW_SIZE, 0, 0 },
+    { "mwindow_mapped_limit", opt_size,
+      GIT_OPT_SET_MWINDOW_MAPPED_LIMIT, GIT_OPT_GET_MWINDOW_MAPPED_LIMIT, 0, 0 },
+    { "mwindow_file_limit", opt_size,
+      GIT_OPT_SET_MWINDOW_FILE_LIMIT, GIT_OPT_GET_MWINDOW_FILE_LIMIT, 0, 0 },
+    { "cache_max_size", opt_cache_max_size,
+      GIT_OPT_SET_CACHE_MAX_SIZE, GIT_OPT_GET_CACHED_MEMORY, 0, 0 },
+    { "enable_caching", opt_bool,
+      GIT_OPT_ENABLE_CACHING, -1, 0, 1 },
+    { "cache_object_limit_commit", opt_cache_object_limit,
+      GIT_OPT_SET_CACHE_OBJECT_LIMIT, -1, GIT_OBJ_COMMIT, 4096 },
+    { "cache_object_limit_tree", opt_cache_object_limit,
+      GIT_OPT_SET_CACHE_OBJECT_LIMIT, -1, GIT_OBJ_TREE, 4096 },
+    { "cache_object_limit_blob", opt_cache_object_limit,
+      GIT_OPT_SET_CACHE_OBJECT_LIMIT, -1, GIT_OBJ_BLOB, 0 },
+    { "cache_object_limit_tag", opt_cache_object_limit,
+      GIT_OPT_SET_CACHE_OBJECT_LIMIT, -1, GIT_OBJ_TAG, 4096 },
+    { "strict_hash_verification", opt_bool,
+      GIT_OPT_ENABLE_STRICT_HASH_VERIFICATION, -1, 0, 1 },
+    { "strict_object_creation", opt_bool,
+      GIT_OPT_ENABLE_STRICT_OBJECT_CREATION, -1, 0, 1 },
+    { "pack_max_objects", opt_size,
+      GIT_OPT_SET_PACK_MAX_OBJECTS, GIT_OPT_GET_PACK_MAX_OBJECTS, 0, 0 },
+};
+
+static constexpr size_t OPTS_COUNT = sizeof(OPTS) / sizeof(OPTS[0]);
+
+// The configured (php.ini or libgit2 default) and current values for each
+// option. These are process-wide just like the libgit2 options themselves, so
+// under ZTS every access after startup holds a lock. (A change made by one
+// thread is still visible to, and may be reverted by, requests on others.)
+static zend_long configured[OPTS_COUNT];
+static zend_long current[OPTS_COUNT];
+
+#ifdef ZTS
+static std::mutex optsMutex;
+#define OPTS_LOCK() std::lock_guard<std::mutex> optsLock(optsMutex)
+#else
+#define OPTS_LOCK()
+#endif
+
+static int opt_apply(const opt_info& info,zend_long value)
+{
+    switch (info.kind) {
+    case opt_size:
+        return git_libgit2_opts(info.setter,static_cast<size_t>(value));
+    case opt_bool:
+        return git_libgit2_opts(info.setter,static_cast<int>(value != 0));
+    case opt_cache_max_size:
+        return git_libgit2_opts(info.setter,static_cast<ssize_t>(value));
+    case opt_cache_object_limit:
+        return git_libgit2_opts(info.setter,
+            static_cast<git_otype>(info.arg),
+            static_cast<size_t>(value));
+    }
+
+    return GIT_ERROR;
+}
+
+static zend_long opt_query(size_t index)
+{
+    const opt_info& info = OPTS[index];
+
+    if (info.kind == opt_cache_max_size) {
+        ssize_t used = 0;
+        ssize_t allowed = 0;
+
+        if (git_libgit2_opts(info.getter,&used,&allowed) == 0) {
+            return static_cast<zend_long>(allowed);
+        }
+    }
+    else if (info.getter >= 0) {
+        size_t value = 0;
+
+        if (git_libgit2_opts(info.getter,&value) == 0) {
+            return static_cast<zend_long>(value);
+        }
+    }
+
+    return current[index];
+}
+
+static int opt_find(const char* name,size_t len)
+{
+    for (size_t i = 0;i < OPTS_COUNT;++i) {
+        if (strlen(OPTS[i].name) == len && memcmp(OPTS[i].name,name,len) == 0) {
+            return static_cast<int>(i);
+        }
+    }
+
+    return -1;
+}
+
+void php_git2::php_git2_opts_init()
+{
+    // Determine the configured value of each option. If the option was not set
+    // in php.ini, then we capture libgit2's default.
+
+    for (size_t i = 0;i < OPTS_COUNT;++i) {
+        const opt_info& info = OPTS[i];
+        char iniName[128];
+        size_t iniNameLen;
+        char* str;
+
+        current[i] = info.defaultValue;
+        configured[i] = opt_query(i);
+        current[i] = configured[i];
+
+        iniNameLen = snprintf(iniName,sizeof(iniName),"git2.%s",info.name);
+        str = zend_ini_string_ex(iniName,iniNameLen,0,nullptr);
+        if (str == nullptr || *str == 0) {
+            continue;
+        }
+
+        zend_long value = zend_atol(str,strlen(str));
+        if (value < 0 || opt_apply(info,value) < 0) {
+            php_error_docref(nullptr,E_WARNING,"Invalid value for '%s': %s",iniName,str);
+            giterr_clear();
+            continue;
+        }
+
+        configured[i] = value;
+        current[i] = value;
+    }
+}
+
+void php_git2::php_git2_opts_request_init()
+{
+    // Revert any options that were changed at runtime by a previous request.
+
+    OPTS_LOCK();
+
+    for (size_t i = 0;i < OPTS_COUNT;++i) {
+        if (current[i] != configured[i]) {
+            opt_apply(OPTS[i],configured[i]);
+            current[i] = configured[i];
+        }
+    }
+}
+
+void php_git2::php_git2_opts_info()
+{
+    char name[128];
+    char value[64];
+    zend_long values[OPTS_COUNT];
+
+    // Query the values before printing since output handlers may run user
+    // code that calls back into git2_opts_get().
+    {
+        OPTS_LOCK();
+
+        for (size_t i = 0;i < OPTS_COUNT;++i) {
+            values[i] = opt_query(i);
+        }
+    }
+
+    for (size_t i = 0;i < OPTS_COUNT;++i) {
+        snprintf(name,sizeof(name),"git2.%s (effective)",OPTS[i].name);
+        snprintf(value,sizeof(value),ZEND_LONG_FMT,values[i]);
+        php_info_print_table_row(2,name,value);
+    }
+}
+
+void php_git2::php_git2_opts_set(const char* name,size_t len,zval* zv)
+{
+    int index = opt_find(name,len);
+    if (index < 0) {
+        throw php_git2_error_exception("Unknown libgit2 option '%s'",name);
+    }
+
+    const opt_info& info = OPTS[index];
+    zend_long value;
+
+    if (info.kind == opt_bool) {
+        value = zend_is_true(zv) ? 1 : 0;
+    }
+    else {
+        value = zval_get_long(zv);
+        if (value < 0) {
+            throw php_git2_error_exception("Value for libgit2 option '%s' must not be negative",name);
+        }
+    }
+
+    OPTS_LOCK();
+
+    int retval = opt_apply(info,value);
+    if (retval < 0) {
+        git_error(retval);
+    }
+
+    current[index] = value;
+}
+
+void php_git2::php_git2_opts_get(zval* zv,const char* name,size_t len)
+{
+    // Return an array of all options if no name was provided.
+
+    OPTS_LOCK();
+
+    if (name == nullptr) {
+        array_init_size(zv,OPTS_COUNT);
+        for (size_t i = 0;i < OPTS_COUNT;++i) {
+            add_assoc_long(zv,OPTS[i].name,opt_query(i));
+        }
+
+        return;
+    }
+
+    int index = opt_find(name,len);
+    if (index < 0) {
+        throw php_git2_error_exception("Unknown libgit2 option '%s'",name);
+    }
+
+    if (OPTS[index].kind == opt_bool) {
+        ZVAL_BOOL(zv,opt_query(index) != 0);
+    }
+    else {
+        ZVAL_LONG(zv,opt_query(index));
+    }
+}
+
+/*
+ * Local Variables:
+ * mode:c++
+ * indent-tabs-mode:nil
+ * tab-width:4
+ * End:
+ */
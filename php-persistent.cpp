@@ -0,0 +1,241 @@
+/*
+ * php-persistent.cpp
+ *
+ * Copyright (C) Roger P. Gee
+ */
+
+#include "php-git2.h"
+#include <ctime>
+extern "C" {
+#include <git2/sys/repository.h>
+}
+using namespace std;
+using namespace php_git2;
+
+// Captures the modification state of the parts of a repository's git directory
+// that tell us whether cached repository data may be stale. Loose refs are not
+// stamped since libgit2 reads them from disk on every lookup.
+
+struct persistent_stamp
+{
+    time_t packedRefs;
+    zend_off_t packedRefsSize;
+    time_t config;
+    zend_off_t configSize;
+    time_t objectsPack;
+
+    bool operator ==(const persistent_stamp& other) const
+    {
+        return packedRefs == other.packedRefs
+            && packedRefsSize == other.packedRefsSize
+            && config == other.config
+            && configSize == other.configSize
+            && objectsPack == other.objectsPack;
+    }
+
+    bool operator !=(const persistent_stamp& other) const
+    {
+        return !(*this == other);
+    }
+};
+
+// Represents a single repository handle kept in the pool. Entries are allocated
+// in persistent memory since they outlive the request that created them.
+
+struct persistent_entry
+{
+    git_repository* repo;
+    persistent_stamp stamp;
+    time_t lastUsed;
+};
+
+static time_t stamp_file(const string& path,zend_off_t* size = nullptr)
+{
+    zend_stat_t st;
+
+    if (VCWD_STAT(path.c_str(),&st) != 0) {
+        if (size != nullptr) {
+            *size = 0;
+        }
+
+        return 0;
+    }
+
+    if (size != nullptr) {
+        *size = st.st_size;
+    }
+
+    return st.st_mtime;
+}
+
+static void stamp_repository(persistent_stamp* stamp,git_repository* repo)
+{
+    // NOTE: git_repository_path() always includes a trailing path separator.
+
+    string base = git_repository_path(repo);
+
+    stamp->packedRefs = stamp_file(base + "packed-refs",&stamp->packedRefsSize);
+    stamp->config = stamp_file(base + "config",&stamp->configSize);
+    stamp->objectsPack = stamp_file(base + "objects/pack");
+}
+
+static void persistent_entry_dtor(zval* zv)
+{
+    persistent_entry* entry = reinterpret_cast<persistent_entry*>(Z_PTR_P(zv));
+
+    git_repository_free(entry->repo);
+    pefree(entry,1);
+}
+
+static int persistent_entry_expired(zval* zv,void* arg)
+{
+    persistent_entry* entry = reinterpret_cast<persistent_entry*>(Z_PTR_P(zv));
+    time_t limit = *reinterpret_cast<time_t*>(arg);
+
+    if (entry->lastUsed < limit) {
+        return ZEND_HASH_APPLY_REMOVE;
+    }
+
+    return ZEND_HASH_APPLY_KEEP;
+}
+
+git_repository* php_git2::php_git2_persistent_repository_open(const char* path,size_t len)
+{
+    HashTable* pool = GIT2_G(persistentRepos);
+    persistent_entry* entry;
+    char realPath[MAXPATHLEN];
+
+    // Key the pool by the canonical path so that different spellings of the
+    // same path (relative, through a symlink, with a trailing separator) share
+    // one handle.
+    if (VCWD_REALPATH(path,realPath) != nullptr) {
+        path = realPath;
+        len = strlen(realPath);
+    }
+
+    if (pool == nullptr) {
+        // Take out an extra libgit2 reference for the lifetime of the pool. This
+        // keeps the library (and its global caches) initialized when the
+        // per-request reference is dropped in post-deactivate.
+        git_libgit2_init();
+
+        pool = reinterpret_cast<HashTable*>(pemalloc(sizeof(HashTable),1));
+        zend_hash_init(pool,8,nullptr,persistent_entry_dtor,1);
+        GIT2_G(persistentRepos) = pool;
+    }
+
+    entry = reinterpret_cast<persistent_entry*>(zend_hash_str_find_ptr(pool,path,len));
+    if (entry != nullptr) {
+        persistent_stamp stamp;
+
+        // If packed refs, the config or packs changed since the handle was last
+        // used, drop the repository's cached ODB, refdb, config and object
+        // cache so they are reloaded lazily. Objects and sub-handles already held by userspace are
+        // reference counted and remain valid.
+        stamp_repository(&stamp,entry->repo);
+        if (stamp != entry->stamp) {
+            int retval = git_repository__cleanup(entry->repo);
+            if (retval < 0) {
+                git_error(retval);
+            }
+
+            entry->stamp = stamp;
+        }
+
+        entry->lastUsed = time(nullptr);
+        return entry->repo;
+    }
+
+    git_repository* repo;
+    int retval = git_repository_open(&repo,path);
+    if (retval < 0) {
+        git_error(retval);
+    }
+
+    entry = reinterpret_cast<persistent_entry*>(pemalloc(sizeof(persistent_entry),1));
+    entry->repo = repo;
+    entry->lastUsed = time(nullptr);
+    stamp_repository(&entry->stamp,repo);
+
+    zend_hash_str_add_ptr(pool,path,len,entry);
+
+    return repo;
+}
+
+bool php_git2::php_git2_persistent_repository_is_pooled(git_repository* repo)
+{
+    HashTable* pool = GIT2_G(persistentRepos);
+    persistent_entry* entry;
+
+    if (pool == nullptr) {
+        return false;
+    }
+
+    ZEND_HASH_FOREACH_PTR(pool,entry) {
+        if (entry->repo == repo) {
+            return true;
+        }
+    } ZEND_HASH_FOREACH_END();
+
+    return false;
+}
+
+void php_git2::php_git2_persistent_repository_trim()
+{
+    // NOTE: This function must only be called once all resources for the
+    // request have been destroyed since objects looked up from a pooled
+    // repository may still reference it.
+
+    HashTable* pool = GIT2_G(persistentRepos);
+    zend_long max = GIT2_G(persistentReposMax);
+    zend_long ttl = GIT2_G(persistentReposTTL);
+
+    if (pool == nullptr) {
+        return;
+    }
+
+    // Evict handles that have been idle for too long.
+    if (ttl > 0) {
+        time_t limit = time(nullptr) - static_cast<time_t>(ttl);
+        zend_hash_apply_with_argument(pool,persistent_entry_expired,&limit);
+    }
+
+    // Evict least recently used handles until the pool is within its limit.
+    while (zend_hash_num_elements(pool) > static_cast<uint32_t>(max < 0 ? 0 : max)) {
+        zend_string* key;
+        zend_string* oldestKey = nullptr;
+        persistent_entry* entry;
+        time_t oldest = 0;
+
+        ZEND_HASH_FOREACH_STR_KEY_PTR(pool,key,entry) {
+            if (oldestKey == nullptr || entry->lastUsed < oldest) {
+                oldestKey = key;
+                oldest = entry->lastUsed;
+            }
+        } ZEND_HASH_FOREACH_END();
+
+        zend_hash_del(pool,oldestKey);
+    }
+}
+
+void php_git2::php_git2_persistent_repository_destroy(zend_git2_globals* gbls)
+{
+    HashTable* pool = gbls->persistentRepos;
+
+    if (pool != nullptr) {
+        zend_hash_destroy(pool);
+        pefree(pool,1);
+        gbls->persistentRepos = nullptr;
+
+        // Release the libgit2 reference taken when the pool was created.
+        git_libgit2_shutdown();
+    }
+}
+
+/*
+ * Local Variables:
+ * mode:c++
+ * indent-tabs-mode:nil
+ * tab-width:4
+ * End:
+ */
@@ -310,7 +310,7 @@ PHP_METHOD(GitRefDBBackend_Internal,iterator_next)
             RETVAL_STRING(target);
         }
         else {
-            convert_oid(return_value,oid);
+            convert_oid_hex(return_value,oid);
         }
 
         git_reference_free(ref);
@@ -376,7 +376,7 @@ PHP_METHOD(GitRefDBBackend_Internal,write)
             throw php_git2_error_exception(
                 "GitRefDBBackend_Internal::write(): signature array is incorrect");
         }
-        convert_oid_fromstr(&oid,old,old_len);
+        convert_oid_fromhex(&oid,old,old_len);
 
         retval = object->backend->write(
             object->backend,
@@ -516,7 +516,7 @@ PHP_METHOD(GitRefDBBackend_Internal,del)
         int retval;
         git_oid oid;
 
-        if (convert_oid_fromstr(&oid,oldid,oldid_len) != 0) {
+        if (convert_oid_fromhex(&oid,oldid,oldid_len) != 0) {
             throw php_git2_exception("GitRefDBBackend_Internal::del(): the provided OID is invalid");
         }
 
@@ -12,21 +12,22 @@ extern "C" {
 }
 using namespace php_git2;
 
+// Number of references requested from iterator_next_batch() per call.
+static constexpr zend_long REFDB_ITERATOR_BATCH_SIZE = 256;
+
 // Helper functions.
 
-static int reference_from_string(git_reference** out,zval* zstr,const char* ref_name)
+static int reference_from_string(git_reference** out,const char* target,const char* ref_name)
 {
     // If the string starts with "ref: " then assume it is a symbolic
     // reference. Otherwise try to decode an OID hex string.
 
-    const char* target = Z_STRVAL_P(zstr);
-
     if (strstr(target,"ref: ") == target) {
         *out = git_reference__alloc_symbolic(ref_name,target);
     }
     else if (strlen(target) == GIT_OID_HEXSZ) {
         git_oid oid;
-        if (convert_oid_fromstr(&oid,target,GIT_OID_HEXSZ) != 0) {
+        if (convert_oid_fromhex(&oid,target,GIT_OID_HEXSZ) != 0) {
             giterr_set_str(GIT_EINVALID,"Invalid OID reference target value");
             return GIT_ERROR;
         }
@@ -122,11 +123,106 @@ struct custom_backend_iterator : git_reference_iterator
 
     // Store last returned name string.
     zval zlast;
+
+    // Store last array returned by iterator_next_batch() and the position of
+    // the next reference in it.
+    zval zbatch;
+    HashPosition pos;
+    bool batched;
 };
 
+// Gets the next reference from the array returned by iterator_next_batch(),
+// fetching another batch when the current one is exhausted. The name is stored
+// in 'zlast' and the target string is returned in 'target'.
+
+static int custom_backend_iterator_next_batched(zend_string** target,custom_backend_iterator* iter)
+{
+    while (true) {
+        if (Z_TYPE(iter->zbatch) == IS_ARRAY) {
+            HashTable* ht = Z_ARRVAL(iter->zbatch);
+            zval* value = zend_hash_get_current_data_ex(ht,&iter->pos);
+
+            if (value != nullptr) {
+                zend_string* key;
+                zend_ulong index;
+
+                zend_hash_get_current_key_ex(ht,&key,&index,&iter->pos);
+                zend_hash_move_forward_ex(ht,&iter->pos);
+
+                zval_ptr_dtor(&iter->zlast);
+                if (key != nullptr) {
+                    ZVAL_STR_COPY(&iter->zlast,key);
+                }
+                else {
+                    ZVAL_LONG(&iter->zlast,index);
+                    convert_to_string(&iter->zlast);
+                }
+
+                *target = zval_get_string(value);
+
+                return GIT_OK;
+            }
+        }
+
+        int result;
+        zval_array<1> params;
+        custom_backend_iterator::method_wrapper method("iterator_next_batch",iter);
+
+        ZVAL_LONG(params[0],REFDB_ITERATOR_BATCH_SIZE);
+
+        // Call userspace method implementation corresponding to refdb
+        // operation.
+
+        result = method.call(params);
+        if (result != GIT_OK) {
+            return result;
+        }
+
+        zval* retval = method.retval();
+
+        // If userspace returned false or an empty array, then iteration is
+        // over.
+        if (Z_TYPE_P(retval) == IS_FALSE
+            || (Z_TYPE_P(retval) == IS_ARRAY && zend_hash_num_elements(Z_ARRVAL_P(retval)) == 0))
+        {
+            return GIT_ITEROVER;
+        }
+
+        if (Z_TYPE_P(retval) != IS_ARRAY) {
+            giterr_set_str(
+                GITERR_INVALID,
+                "GitRefDBBackend::iterator_next_batch(): method must return an array");
+            return GIT_EPHP_ERROR;
+        }
+
+        zval_ptr_dtor(&iter->zbatch);
+        ZVAL_COPY(&iter->zbatch,retval);
+        zend_hash_internal_pointer_reset_ex(Z_ARRVAL(iter->zbatch),&iter->pos);
+    }
+}
+
 static int custom_backend_iterator_next(git_reference** ref,custom_backend_iterator* iter)
 {
     int result;
+    custom_backend_iterator::method_wrapper::object_wrapper object(iter);
+    php_refdb_backend_cache& cache = object.backing()->cache;
+
+    if (iter->batched) {
+        zend_string* target;
+
+        result = custom_backend_iterator_next_batched(&target,iter);
+        if (result == GIT_OK) {
+            result = reference_from_string(ref,ZSTR_VAL(target),Z_STRVAL(iter->zlast));
+            if (result == GIT_OK && cache.enabled()) {
+                cache.put(Z_STRVAL(iter->zlast),ZSTR_VAL(target),ZSTR_LEN(target));
+            }
+
+            zend_string_release(target);
+        }
+
+        return result;
+    }
+
     zval_array<1> params;
     custom_backend_iterator::method_wrapper method("iterator_next",iter);
 
@@ -150,7 +246,10 @@ static int custom_backend_iterator_next(git_reference** ref,custom_backend_itera
 
             // Return values.
             convert_to_string(retval);
-            result = reference_from_string(ref,retval,Z_STRVAL(iter->zlast));
+            result = reference_from_string(ref,Z_STRVAL_P(retval),Z_STRVAL(iter->zlast));
+            if (result == GIT_OK && cache.enabled()) {
+                cache.put(Z_STRVAL(iter->zlast),Z_STRVAL_P(retval),Z_STRLEN_P(retval));
+            }
         }
     }
 
@@ -160,6 +259,19 @@ static int custom_backend_iterator_next(git_reference** ref,custom_backend_itera
 static int custom_backend_iterator_next_name(const char** ref_name,custom_backend_iterator* iter)
 {
     int result;
+
+    if (iter->batched) {
+        zend_string* target;
+
+        result = custom_backend_iterator_next_batched(&target,iter);
+        if (result == GIT_OK) {
+            zend_string_release(target);
+            *ref_name = Z_STRVAL(iter->zlast);
+        }
+
+        return result;
+    }
+
     zval_array<1> params;
     custom_backend_iterator::method_wrapper method("iterator_next",iter);
 
@@ -191,6 +303,7 @@ static void custom_backend_iterator_free(custom_backend_iterator* iter)
 {
     zval_ptr_dtor(&iter->thisobj);
     zval_ptr_dtor(&iter->zlast);
+    zval_ptr_dtor(&iter->zbatch);
     efree(iter);
 }
 
@@ -223,6 +336,7 @@ static int refdb_backend_has_property(zval* object,
 // implementation.
 static PHP_EMPTY_METHOD(GitRefDBBackend,iterator_new);
 static PHP_EMPTY_METHOD(GitRefDBBackend,iterator_next);
+static PHP_EMPTY_METHOD(GitRefDBBackend,iterator_next_batch);
 static PHP_EMPTY_METHOD(GitRefDBBackend,compress);
 static PHP_EMPTY_METHOD(GitRefDBBackend,lock);
 static PHP_EMPTY_METHOD(GitRefDBBackend,unlock);
@@ -232,6 +346,7 @@ zend_function_entry php_git2::refdb_backend_methods[] = {
     PHP_ABSTRACT_ME(GitRefDBBackend,lookup,NULL)
     PHP_ME(GitRefDBBackend,iterator_new,NULL,ZEND_ACC_PUBLIC)
     PHP_ME(GitRefDBBackend,iterator_next,NULL,ZEND_ACC_PUBLIC)
+    PHP_ME(GitRefDBBackend,iterator_next_batch,NULL,ZEND_ACC_PUBLIC)
     PHP_ABSTRACT_ME(GitRefDBBackend,write,NULL)
     PHP_ABSTRACT_ME(GitRefDBBackend,rename,NULL)
     PHP_ABSTRACT_ME(GitRefDBBackend,del,NULL)
@@ -309,6 +424,148 @@ int refdb_backend_has_property(zval* object,
     return std->has_property(object,member,has_set_exists,cache_slot);
 }
 
+// Implementation of php_refdb_backend_cache
+
+php_refdb_backend_cache::php_refdb_backend_cache():
+    capacity(0), hits(0), misses(0)
+{
+}
+
+const char* php_refdb_backend_cache::lookup(const char* refName)
+{
+    if (!enabled()) {
+        return nullptr;
+    }
+
+    entry* ent = find(refName);
+
+    if (ent == nullptr || !ent->hasTarget) {
+        misses += 1;
+        return nullptr;
+    }
+
+    hits += 1;
+    return ent->target.c_str();
+}
+
+bool php_refdb_backend_cache::exists(int* result,const char* refName)
+{
+    if (!enabled()) {
+        return false;
+    }
+
+    entry* ent = find(refName);
+
+    if (ent == nullptr) {
+        misses += 1;
+        return false;
+    }
+
+    *result = ent->exists;
+    hits += 1;
+
+    return true;
+}
+
+void php_refdb_backend_cache::put(const char* refName,const char* target,size_t length)
+{
+    if (!enabled()) {
+        return;
+    }
+
+    entry* ent = insert(refName);
+
+    ent->exists = true;
+    ent->hasTarget = true;
+    ent->target.assign(target,length);
+}
+
+void php_refdb_backend_cache::put_exists(const char* refName,bool exists)
+{
+    if (!enabled()) {
+        return;
+    }
+
+    entry* ent = insert(refName);
+
+    // Keep a previously looked up target if the reference still exists.
+    if (!exists || !ent->exists) {
+        ent->hasTarget = false;
+        ent->target.clear();
+    }
+    ent->exists = exists;
+}
+
+void php_refdb_backend_cache::remove(const char* refName)
+{
+    auto iter = lookupTable.find(refName);
+    if (iter != lookupTable.end()) {
+        entries.erase(iter->second);
+        lookupTable.erase(iter);
+    }
+}
+
+void php_refdb_backend_cache::set_capacity(size_t count)
+{
+    capacity = count;
+
+    while (entries.size() > capacity) {
+        lookupTable.erase(entries.back().name);
+        entries.pop_back();
+    }
+}
+
+void php_refdb_backend_cache::clear()
+{
+    entries.clear();
+    lookupTable.clear();
+}
+
+void php_refdb_backend_cache::get_stats(zval* zv) const
+{
+    array_init_size(zv,4);
+    add_assoc_long_ex(zv,"capacity",sizeof("capacity")-1,static_cast<zend_long>(capacity));
+    add_assoc_long_ex(zv,"entries",sizeof("entries")-1,static_cast<zend_long>(entries.size()));
+    add_assoc_long_ex(zv,"hits",sizeof("hits")-1,static_cast<zend_long>(hits));
+    add_assoc_long_ex(zv,"misses",sizeof("misses")-1,static_cast<zend_long>(misses));
+}
+
+php_refdb_backend_cache::entry* php_refdb_backend_cache::find(const char* refName)
+{
+    auto iter = lookupTable.find(refName);
+    if (iter == lookupTable.end()) {
+        return nullptr;
+    }
+
+    // Move the entry to the front of the list since it is now the most
+    // recently used.
+    entries.splice(entries.begin(),entries,iter->second);
+
+    return &*iter->second;
+}
+
+php_refdb_backend_cache::entry* php_refdb_backend_cache::insert(const char* refName)
+{
+    entry* ent = find(refName);
+    if (ent != nullptr) {
+        return ent;
+    }
+
+    // Evict the least recently used entry to make room.
+    if (entries.size() >= capacity) {
+        lookupTable.erase(entries.back().name);
+        entries.pop_back();
+    }
+
+    entries.emplace_front();
+    entries.front().name = refName;
+    entries.front().exists = false;
+    entries.front().hasTarget = false;
+    lookupTable.emplace(entries.front().name,entries.begin());
+
+    return &entries.front();
+}
+
 // Implementation of php_refdb_backend_object
 
 php_refdb_backend_object::php_refdb_backend_object():
@@ -377,6 +634,11 @@ void php_refdb_backend_object::assign_owner(php_git_refdb* newOwner)
     int result;
     zval_array<1> params;
     method_wrapper method("exists",backend);
+    php_refdb_backend_cache& cache = method.backing()->cache;
+
+    if (cache.exists(exists,ref_name)) {
+        return GIT_OK;
+    }
 
     ZVAL_STRING(params[0],ref_name);
 
@@ -390,6 +652,7 @@ void php_refdb_backend_object::assign_owner(php_git_refdb* newOwner)
 
         convert_to_boolean(retval);
         *exists = Z_TYPE_P(retval) == IS_TRUE;
+        cache.put_exists(ref_name,*exists);
     }
 
     return result;
@@ -401,8 +664,15 @@ void php_refdb_backend_object::assign_owner(php_git_refdb* newOwner)
     const char *ref_name)
 {
     int result;
+    const char* target;
     zval_array<1> params;
     method_wrapper method("lookup",backend);
+    php_refdb_backend_cache& cache = method.backing()->cache;
+
+    target = cache.lookup(ref_name);
+    if (target != nullptr) {
+        return reference_from_string(out,target,ref_name);
+    }
 
     ZVAL_STRING(params[0],ref_name);
 
@@ -415,7 +685,10 @@ void php_refdb_backend_object::assign_owner(php_git_refdb* newOwner)
         // Return reference from method call return value.
 
         convert_to_string(retval);
-        result = reference_from_string(out,retval,ref_name);
+        result = reference_from_string(out,Z_STRVAL_P(retval),ref_name);
+        if (result == GIT_OK) {
+            cache.put(ref_name,Z_STRVAL_P(retval),Z_STRLEN_P(retval));
+        }
     }
 
     return result;
@@ -453,6 +726,13 @@ void php_refdb_backend_object::assign_owner(php_git_refdb* newOwner)
 
         ZVAL_COPY(&custom->thisobj,thisobj);
         ZVAL_NULL(&custom->zlast);
+        ZVAL_UNDEF(&custom->zbatch);
+
+        // Fetch references in batches if the class supports it.
+        custom->batched = is_method_overridden(
+            Z_OBJCE_P(thisobj),
+            "iterator_next_batch",
+            sizeof("iterator_next_batch")-1);
 
         *iter = custom;
     }
@@ -494,12 +774,16 @@ void php_refdb_backend_object::assign_owner(php_git_refdb* newOwner)
         ZVAL_STRING(params[3],message);
     }
     if (old != nullptr) {
-        convert_oid(params[4],old);
+        convert_oid_hex(params[4],old);
     }
     if (old_target != nullptr) {
         ZVAL_STRING(params[5],old_target);
     }
 
+    // Invalidate the cached reference before the userspace method can change
+    // it.
+    method.backing()->cache.remove(git_reference_name(ref));
+
     // Call userspace method implementation corresponding to refdb operation.
 
     result = method.call(params);
@@ -520,6 +804,9 @@ void php_refdb_backend_object::assign_owner(php_git_refdb* newOwner)
     zval_array<5> params;
     method_wrapper method("rename",backend);
 
+    method.backing()->cache.remove(old_name);
+    method.backing()->cache.remove(new_name);
+
     ZVAL_STRING(params[0],old_name);
     ZVAL_STRING(params[1],new_name);
     ZVAL_BOOL(params[2],1);
@@ -535,7 +822,7 @@ void php_refdb_backend_object::assign_owner(php_git_refdb* newOwner)
         zval* retval = method.retval();
 
         convert_to_string(retval);
-        result = reference_from_string(out,retval,new_name);
+        result = reference_from_string(out,Z_STRVAL_P(retval),new_name);
     }
 
     return result;
@@ -551,9 +838,11 @@ void php_refdb_backend_object::assign_owner(php_git_refdb* newOwner)
     zval_array<3> params;
     method_wrapper method("del",backend);
 
+    method.backing()->cache.remove(ref_name);
+
     ZVAL_STRING(params[0],ref_name);
     if (old_id != nullptr) {
-        convert_oid(params[1],old_id);
+        convert_oid_hex(params[1],old_id);
     }
     if (old_target != nullptr) {
         ZVAL_STRING(params[3],old_target);
@@ -818,6 +1107,17 @@ void php_refdb_backend_object::assign_owner(php_git_refdb* newOwner)
         ZVAL_STRING(params[5],message);
     }
 
+    // The locked reference is updated or deleted on success. We do not know
+    // its name when it is deleted, so the whole cache is dropped in that case.
+    if (success) {
+        if (ref != nullptr) {
+            method.backing()->cache.remove(git_reference_name(ref));
+        }
+        else {
+            method.backing()->cache.clear();
+        }
+    }
+
     // Call userspace method implementation corresponding to refdb operation.
 
     result = method.call(params);
@@ -884,10 +1184,12 @@ php_refdb_backend_object::git_refdb_backend_php::git_refdb_backend_php(zend_obje
     reflog_rename = php_refdb_backend_object::reflog_rename;
     reflog_delete = php_refdb_backend_object::reflog_delete;
     if (is_method_overridden(obj->ce,"iterator_new",sizeof("iterator_new")-1)) {
-        if (!is_method_overridden(obj->ce,"iterator_next",sizeof("iterator_next")-1)) {
+        if (!is_method_overridden(obj->ce,"iterator_next",sizeof("iterator_next")-1)
+            && !is_method_overridden(obj->ce,"iterator_next_batch",sizeof("iterator_next_batch")-1))
+        {
             throw php_git2_error_exception(
-                "Cannot create custom refdb backend: "
-                "must implement iterator_next() with iterator_new()");
+                "Cannot create custom refdb backend: must implement "
+                "iterator_next() or iterator_next_batch() with iterator_new()");
         }
 
         iterator = php_refdb_backend_object::iterator;
@@ -0,0 +1,135 @@
+/*
+ * php-resource.cpp
+ *
+ * Copyright (C) Roger P. Gee
+ */
+
+#include "php-resource.h"
+using namespace std;
+using namespace php_git2;
+
+// Number of objects carved out of each slab.
+static constexpr size_t SLAB_OBJECTS = 32;
+
+// List of all pools that have been created (by this thread under ZTS).
+GIT2_POOL_STORAGE git2_resource_pool* poolList = nullptr;
+
+git2_resource_pool::git2_resource_pool(size_t objectSize,const char* typeName):
+    name(typeName), size(ZEND_MM_ALIGNED_SIZE(objectSize)), slabs(nullptr),
+    freeList(nullptr), cursor(nullptr), end(nullptr), live(0), allocs(0),
+    reuses(0), slabCount(0)
+{
+    nextPool = poolList;
+    poolList = this;
+}
+
+void* git2_resource_pool::alloc()
+{
+    void* object;
+
+    allocs += 1;
+    live += 1;
+
+    // Recycle an object destroyed earlier in the request if possible.
+    if (freeList != nullptr) {
+        object = freeList;
+        freeList = freeList->next;
+        reuses += 1;
+
+        return object;
+    }
+
+    if (cursor == end) {
+        const size_t header = ZEND_MM_ALIGNED_SIZE(sizeof(slab));
+        slab* s;
+
+        s = reinterpret_cast<slab*>(safe_emalloc(SLAB_OBJECTS,size,header));
+        s->next = slabs;
+        slabs = s;
+        slabCount += 1;
+
+        cursor = reinterpret_cast<char*>(s) + header;
+        end = cursor + SLAB_OBJECTS * size;
+    }
+
+    object = cursor;
+    cursor += size;
+
+    return object;
+}
+
+void git2_resource_pool::release(void* object)
+{
+    free_node* node = reinterpret_cast<free_node*>(object);
+
+    node->next = freeList;
+    freeList = node;
+    live -= 1;
+}
+
+/*static*/ void git2_resource_pool::reset_all()
+{
+    for (git2_resource_pool* pool = poolList;pool != nullptr;pool = pool->nextPool) {
+        slab* s = pool->slabs;
+
+        while (s != nullptr) {
+            slab* next = s->next;
+            efree(s);
+            s = next;
+        }
+
+        pool->slabs = nullptr;
+        pool->freeList = nullptr;
+        pool->cursor = nullptr;
+        pool->end = nullptr;
+        pool->live = 0;
+        pool->allocs = 0;
+        pool->reuses = 0;
+        pool->slabCount = 0;
+    }
+}
+
+/*static*/ void git2_resource_pool::get_stats(zval* zv)
+{
+    array_init(zv);
+
+    for (git2_resource_pool* pool = poolList;pool != nullptr;pool = pool->nextPool) {
+        zval* entry;
+
+        // Several pools may share a resource type name (e.g. a type and its
+        // nofree variant); their counters are combined.
+
+        entry = zend_hash_str_find(Z_ARRVAL_P(zv),pool->name,strlen(pool->name));
+        if (entry == nullptr) {
+            zval zentry;
+
+            array_init_size(&zentry,5);
+            add_assoc_long_ex(&zentry,"live",sizeof("live")-1,0);
+            add_assoc_long_ex(&zentry,"allocs",sizeof("allocs")-1,0);
+            add_assoc_long_ex(&zentry,"reuses",sizeof("reuses")-1,0);
+            add_assoc_long_ex(&zentry,"slabs",sizeof("slabs")-1,0);
+            add_assoc_long_ex(&zentry,"bytes",sizeof("bytes")-1,0);
+
+            entry = zend_hash_str_update(Z_ARRVAL_P(zv),
+                pool->name,
+                strlen(pool->name),
+                &zentry);
+        }
+
+        HashTable* ht = Z_ARRVAL_P(entry);
+        Z_LVAL_P(zend_hash_str_find(ht,"live",sizeof("live")-1)) += pool->live;
+        Z_LVAL_P(zend_hash_str_find(ht,"allocs",sizeof("allocs")-1)) += pool->allocs;
+        Z_LVAL_P(zend_hash_str_find(ht,"reuses",sizeof("reuses")-1)) += pool->reuses;
+        Z_LVAL_P(zend_hash_str_find(ht,"slabs",sizeof("slabs")-1)) += pool->slabCount;
+        Z_LVAL_P(zend_hash_str_find(ht,"bytes",sizeof("bytes")-1))
+            += pool->slabCount * SLAB_OBJECTS * pool->size;
+    }
+}
+
+/*
+ * Local Variables:
+ * mode:c++
+ * indent-tabs-mode:nil
+ * tab-width:4
+ * End:
+ */
@@ -11,8 +11,63 @@
 #include <typeinfo>
 #include <iostream>
 
+// Pools are request-scoped. Under ZTS each thread gets its own set of pools.
+#ifdef ZTS
+#define GIT2_POOL_STORAGE static thread_local
+#else
+#define GIT2_POOL_STORAGE static
+#endif
+
 namespace php_git2
 {
+    // Provide a slab allocator for resource objects. Each resource type has its
+    // own pool; objects are carved out of larger request-allocated slabs and
+    // recycled through a free list when the resource is destroyed. All slabs
+    // are released at the end of the request.
+
+    class git2_resource_pool
+    {
+    public:
+        git2_resource_pool(size_t objectSize,const char* typeName);
+
+        void* alloc();
+        void release(void* object);
+
+        // Releases the slabs for all pools. This must only be called once all
+        // resources for the request have been destroyed.
+        static void reset_all();
+
+        // Fills an array with the counters for each pool, keyed by resource
+        // type name.
+        static void get_stats(zval* zv);
+
+    private:
+        struct slab
+        {
+            slab* next;
+        };
+
+        struct free_node
+        {
+            free_node* next;
+        };
+
+        const char* name;
+        size_t size;
+        slab* slabs;
+        free_node* freeList;
+        char* cursor;
+        char* end;
+
+        // Counters for the current request.
+        zend_ulong live;
+        zend_ulong allocs;
+        zend_ulong reuses;
+        zend_ulong slabCount;
+
+        git2_resource_pool* nextPool;
+    };
+
     // Provide a base class for git2_resource that can dynamically dispatch
     // calls to various instantiations of git2_resource to free the resource
     // handle. This also allows us to polymorphically store resource
@@ -34,6 +89,11 @@ namespace php_git2
             ref += 1;
         }
 
+        void set_pool(git2_resource_pool* resourcePool)
+        {
+            pool = resourcePool;
+        }
+
         static void free_recursive(git2_resource_base* self)
         {
             // We must free the git2 handle. If the handle was freed, then free
@@ -45,13 +105,18 @@ namespace php_git2
                     free_recursive(self->parent);
                 }
 
-                efree(self);
+                if (self->pool != nullptr) {
+                    self->pool->release(self);
+                }
+                else {
+                    efree(self);
+                }
             }
         }
 
     protected:
         git2_resource_base():
-            ref(1), parent(nullptr)
+            ref(1), parent(nullptr), pool(nullptr)
         {
         }
 
@@ -70,6 +135,9 @@ namespace php_git2
         // A reference to a parent resource object. This allows the resource to
         // define a single dependency for its lifetime.
         git2_resource_base* parent;
+
+        // The pool from which the object was allocated, if any.
+        git2_resource_pool* pool;
     };
 
     // Encapsulate resource structure and basic operations.
@@ -209,12 +277,26 @@ namespace php_git2
 
     // Provide a function for creating resource objects. This must exist outside
     // of the git2_resource<T> class so that we can allocate derived objects.
+    // Objects are allocated from a pool specific to the (derived) type.
+
+    template<typename GitResource>
+    git2_resource_pool& php_git2_resource_pool()
+    {
+        GIT2_POOL_STORAGE git2_resource_pool pool(
+            sizeof(GitResource),
+            GitResource::resource_name());
+
+        return pool;
+    }
 
     template<typename GitResource>
     GitResource* php_git2_create_resource()
     {
+        git2_resource_pool& pool = php_git2_resource_pool<GitResource>();
         GitResource* obj;
-        obj = new (emalloc(sizeof(GitResource))) GitResource;
+
+        obj = new (pool.alloc()) GitResource;
+        obj->set_pool(&pool);
         return obj;
     }
 
@@ -0,0 +1,528 @@
+/*
+ * php-stream.cpp
+ *
+ * Copyright (C) Roger P. Gee
+ */
+
+#include "php-git2.h"
+#include <string>
+using namespace std;
+using namespace php_git2;
+
+// Provide PHP streams that read directly from libgit2 storage. Blob streams
+// serve the blob's raw content buffer in place (and support the mmap API so
+// fpassthru() and stream_copy_to_stream() avoid intermediate copies). ODB
+// streams pull chunks from a git_odb_stream on demand.
+
+#if PHP_VERSION_ID >= 70400
+typedef ssize_t stream_io_t;
+#define STREAM_IO_ERROR -1
+#else
+typedef size_t stream_io_t;
+#define STREAM_IO_ERROR 0
+#endif
+
+#define GIT2_STREAM_SCHEME "git2"
+
+struct blob_stream_data
+{
+    // The PHP value that owns the blob, if any. If this is undefined, then the
+    // blob is owned by the stream.
+    zval owner;
+
+    git_blob* blob;
+
+    // The repository that owns the blob if it was opened for the stream (and
+    // is not pooled).
+    git_repository* repo;
+
+    const char* data;
+    size_t size;
+    size_t pos;
+};
+
+struct odb_stream_data
+{
+    // The GitODBStream object that owns the git_odb_stream.
+    zval owner;
+
+    git_odb_stream* stream;
+};
+
+// Blob stream operations
+
+static stream_io_t blob_stream_write(php_stream* stream,const char* buf,size_t count)
+{
+    return STREAM_IO_ERROR;
+}
+
+static stream_io_t blob_stream_read(php_stream* stream,char* buf,size_t count)
+{
+    blob_stream_data* data = reinterpret_cast<blob_stream_data*>(stream->abstract);
+    size_t n = data->size - data->pos;
+
+    if (count < n) {
+        n = count;
+    }
+
+    memcpy(buf,data->data + data->pos,n);
+    data->pos += n;
+    if (data->pos >= data->size) {
+        stream->eof = 1;
+    }
+
+    return n;
+}
+
+static int blob_stream_close(php_stream* stream,int closeHandle)
+{
+    blob_stream_data* data = reinterpret_cast<blob_stream_data*>(stream->abstract);
+
+    if (Z_TYPE(data->owner) != IS_UNDEF) {
+        zval_ptr_dtor(&data->owner);
+    }
+    else {
+        git_blob_free(data->blob);
+    }
+
+    if (data->repo != nullptr) {
+        git_repository_free(data->repo);
+    }
+
+    efree(data);
+    return 0;
+}
+
+static int blob_stream_flush(php_stream* stream)
+{
+    return 0;
+}
+
+static int blob_stream_seek(php_stream* stream,zend_off_t offset,int whence,zend_off_t* newOffset)
+{
+    blob_stream_data* data = reinterpret_cast<blob_stream_data*>(stream->abstract);
+    zend_off_t base;
+
+    switch (whence) {
+    case SEEK_SET:
+        base = 0;
+        break;
+    case SEEK_CUR:
+        base = static_cast<zend_off_t>(data->pos);
+        break;
+    case SEEK_END:
+        base = static_cast<zend_off_t>(data->size);
+        break;
+    default:
+        return -1;
+    }
+
+    if (base + offset < 0 || static_cast<size_t>(base + offset) > data->size) {
+        return -1;
+    }
+
+    data->pos = static_cast<size_t>(base + offset);
+    stream->eof = (data->pos >= data->size);
+    *newOffset = static_cast<zend_off_t>(data->pos);
+
+    return 0;
+}
+
+static int blob_stream_stat(php_stream* stream,php_stream_statbuf* ssb)
+{
+    blob_stream_data* data = reinterpret_cast<blob_stream_data*>(stream->abstract);
+
+    memset(ssb,0,sizeof(php_stream_statbuf));
+    ssb->sb.st_mode = S_IFREG | 0444;
+    ssb->sb.st_size = static_cast<zend_off_t>(data->size);
+    ssb->sb.st_nlink = 1;
+
+    return 0;
+}
+
+static int blob_stream_set_option(php_stream* stream,int option,int value,void* ptrparam)
+{
+    blob_stream_data* data = reinterpret_cast<blob_stream_data*>(stream->abstract);
+
+    if (option != PHP_STREAM_OPTION_MMAP_API) {
+        return PHP_STREAM_OPTION_RETURN_NOTIMPL;
+    }
+
+    // The blob content is already in memory, so "mapping" a range just hands
+    // out a pointer into the blob buffer. Only read access is supported.
+
+    switch (value) {
+    case PHP_STREAM_MMAP_SUPPORTED:
+        return PHP_STREAM_OPTION_RETURN_OK;
+
+    case PHP_STREAM_MMAP_MAP_RANGE: {
+        php_stream_mmap_range* range = reinterpret_cast<php_stream_mmap_range*>(ptrparam);
+
+        if (range->mode != PHP_STREAM_MAP_MODE_READONLY
+            && range->mode != PHP_STREAM_MAP_MODE_SHARED_READONLY)
+        {
+            return PHP_STREAM_OPTION_RETURN_ERR;
+        }
+        if (range->offset > data->size) {
+            return PHP_STREAM_OPTION_RETURN_ERR;
+        }
+        if (range->length == 0 || range->length > data->size - range->offset) {
+            range->length = data->size - range->offset;
+        }
+
+        range->mapped = const_cast<char*>(data->data) + range->offset;
+        return PHP_STREAM_OPTION_RETURN_OK;
+    }
+
+    case PHP_STREAM_MMAP_UNMAP:
+        return PHP_STREAM_OPTION_RETURN_OK;
+    }
+
+    return PHP_STREAM_OPTION_RETURN_NOTIMPL;
+}
+
+static php_stream_ops blob_stream_ops = {
+    blob_stream_write,
+    blob_stream_read,
+    blob_stream_close,
+    blob_stream_flush,
+    "git2 blob",
+    blob_stream_seek,
+    nullptr, // cast
+    blob_stream_stat,
+    blob_stream_set_option
+};
+
+// ODB stream operations
+
+static stream_io_t odb_stream_write(php_stream* stream,const char* buf,size_t count)
+{
+    return STREAM_IO_ERROR;
+}
+
+static stream_io_t odb_stream_read(php_stream* stream,char* buf,size_t count)
+{
+    odb_stream_data* data = reinterpret_cast<odb_stream_data*>(stream->abstract);
+    int retval;
+
+    retval = git_odb_stream_read(data->stream,buf,count);
+    if (retval < 0) {
+        const git_error* err = giterr_last();
+        php_error_docref(nullptr,E_WARNING,"Failed to read ODB stream: %s",
+            err != nullptr ? err->message : "unknown error");
+
+        stream->eof = 1;
+        return STREAM_IO_ERROR;
+    }
+
+    if (retval == 0) {
+        stream->eof = 1;
+    }
+
+    return static_cast<stream_io_t>(retval);
+}
+
+static int odb_stream_close(php_stream* stream,int closeHandle)
+{
+    odb_stream_data* data = reinterpret_cast<odb_stream_data*>(stream->abstract);
+
+    zval_ptr_dtor(&data->owner);
+    efree(data);
+
+    return 0;
+}
+
+static int odb_stream_flush(php_stream* stream)
+{
+    return 0;
+}
+
+static php_stream_ops odb_stream_ops = {
+    odb_stream_write,
+    odb_stream_read,
+    odb_stream_close,
+    odb_stream_flush,
+    "git2 odb",
+    nullptr, // seek
+    nullptr, // cast
+    nullptr, // stat
+    nullptr  // set_option
+};
+
+static php_stream* blob_stream_create(zval* owner,git_blob* blob,git_repository* repo)
+{
+    blob_stream_data* data;
+    php_stream* stream;
+
+    data = reinterpret_cast<blob_stream_data*>(emalloc(sizeof(blob_stream_data)));
+    if (owner != nullptr) {
+        ZVAL_COPY(&data->owner,owner);
+    }
+    else {
+        ZVAL_UNDEF(&data->owner);
+    }
+    data->blob = blob;
+    data->repo = repo;
+    data->data = reinterpret_cast<const char*>(git_blob_rawcontent(blob));
+    data->size = static_cast<size_t>(git_blob_rawsize(blob));
+    data->pos = 0;
+
+    stream = php_stream_alloc(&blob_stream_ops,data,nullptr,"rb");
+    if (stream == nullptr) {
+        zval_ptr_dtor(&data->owner);
+        efree(data);
+    }
+
+    return stream;
+}
+
+// git2:// wrapper
+
+// Resolves a URL of the form git2://<repo-path>/<rev>:<path> (or
+// git2://<repo-path>/<blob-id>) to a blob. The repository path is determined by
+// finding the longest prefix before the revspec that names a repository. On
+// success the function returns true and the caller must free the blob (and the
+// repository, if non-null). Candidate repository paths are subject to
+// open_basedir. The persistent repository pool is only used when the stream
+// context sets the 'git2' option 'persistent'.
+
+static bool wrapper_resolve(php_stream_wrapper* wrapper,
+    const char* url,
+    int options,
+    php_stream_context* context,
+    git_blob** outBlob,
+    git_repository** outRepo)
+{
+    const char* spec = url;
+    const char* colon;
+    const char* slash = nullptr;
+    git_repository* repo = nullptr;
+    git_object* object;
+    bool pooled = false;
+    int retval;
+    string repoPath;
+
+    if (strncasecmp(spec,GIT2_STREAM_SCHEME "://",sizeof(GIT2_STREAM_SCHEME "://")-1) == 0) {
+        spec += sizeof(GIT2_STREAM_SCHEME "://")-1;
+    }
+
+    // The revspec may also name a blob directly by ID, in which case there is
+    // no ':' separator.
+    colon = strchr(spec,':');
+    if (colon == nullptr) {
+        colon = spec + strlen(spec);
+    }
+
+    // Try each candidate repository path from the longest to the shortest so
+    // that revisions containing '/' (e.g. refs/heads/main) resolve correctly.
+
+    for (const char* p = colon;p > spec;--p) {
+        if (p[-1] != '/') {
+            continue;
+        }
+
+        repoPath.assign(spec,p - spec - 1);
+        if (!repoPath.empty()
+            && php_check_open_basedir_ex(repoPath.c_str(),0) == 0
+            && git_repository_open_ext(nullptr,repoPath.c_str(),GIT_REPOSITORY_OPEN_NO_SEARCH,nullptr) == 0)
+        {
+            slash = p - 1;
+            break;
+        }
+    }
+
+    if (slash == nullptr) {
+        php_stream_wrapper_log_error(wrapper,options,
+            "Invalid git2 URL '%s': expected git2://<repo-path>/<rev>:<path>",url);
+        giterr_clear();
+        return false;
+    }
+
+    if (context != nullptr && GIT2_G(persistentReposMax) > 0) {
+        zval* option = php_stream_context_get_option(context,"git2","persistent");
+        pooled = (option != nullptr && zend_is_true(option));
+    }
+
+    if (pooled) {
+        try {
+            repo = php_git2_persistent_repository_open(repoPath.data(),repoPath.size());
+        } catch (php_git2_exception_base& ex) {
+            php_stream_wrapper_log_error(wrapper,options,
+                "Failed to open repository '%s': %s",repoPath.c_str(),ex.what());
+            return false;
+        }
+    }
+    else {
+        retval = git_repository_open(&repo,repoPath.c_str());
+        if (retval < 0) {
+            const git_error* err = giterr_last();
+            php_stream_wrapper_log_error(wrapper,options,
+                "Failed to open repository '%s': %s",repoPath.c_str(),
+                err != nullptr ? err->message : "unknown error");
+            return false;
+        }
+    }
+
+    // A '.git' file may redirect to a git directory elsewhere on disk, so check
+    // the resolved path as well.
+    if (php_check_open_basedir_ex(git_repository_path(repo),options & REPORT_ERRORS) != 0) {
+        if (!pooled) {
+            git_repository_free(repo);
+        }
+
+        return false;
+    }
+
+    retval = git_revparse_single(&object,repo,slash + 1);
+    if (retval < 0 || git_object_type(object) != GIT_OBJ_BLOB) {
+        if (retval < 0) {
+            const git_error* err = giterr_last();
+            php_stream_wrapper_log_error(wrapper,options,
+                "Failed to resolve '%s': %s",slash + 1,
+                err != nullptr ? err->message : "unknown error");
+        }
+        else {
+            php_stream_wrapper_log_error(wrapper,options,
+                "Failed to resolve '%s': object is not a blob",slash + 1);
+            git_object_free(object);
+        }
+
+        if (!pooled) {
+            git_repository_free(repo);
+        }
+
+        return false;
+    }
+
+    *outBlob = reinterpret_cast<git_blob*>(object);
+    *outRepo = pooled ? nullptr : repo;
+
+    return true;
+}
+
+static php_stream* wrapper_open(php_stream_wrapper* wrapper,
+    const char* filename,
+    const char* mode,
+    int options,
+    zend_string** openedPath,
+    php_stream_context* context STREAMS_DC)
+{
+    git_blob* blob;
+    git_repository* repo;
+    php_stream* stream;
+
+    if (strchr(mode,'w') != nullptr || strchr(mode,'a') != nullptr
+        || strchr(mode,'x') != nullptr || strchr(mode,'c') != nullptr
+        || strchr(mode,'+') != nullptr)
+    {
+        php_stream_wrapper_log_error(wrapper,options,
+            "git2 streams only support read mode");
+        return nullptr;
+    }
+
+    if (!wrapper_resolve(wrapper,filename,options,context,&blob,&repo)) {
+        return nullptr;
+    }
+
+    stream = blob_stream_create(nullptr,blob,repo);
+    if (stream == nullptr) {
+        git_blob_free(blob);
+        if (repo != nullptr) {
+            git_repository_free(repo);
+        }
+    }
+
+    return stream;
+}
+
+static int wrapper_url_stat(php_stream_wrapper* wrapper,
+    const char* url,
+    int flags,
+    php_stream_statbuf* ssb,
+    php_stream_context* context)
+{
+    git_blob* blob;
+    git_repository* repo;
+    int options = (flags & PHP_STREAM_URL_STAT_QUIET) ? 0 : REPORT_ERRORS;
+
+    if (!wrapper_resolve(wrapper,url,options,context,&blob,&repo)) {
+        return -1;
+    }
+
+    memset(ssb,0,sizeof(php_stream_statbuf));
+    ssb->sb.st_mode = S_IFREG | 0444;
+    ssb->sb.st_size = static_cast<zend_off_t>(git_blob_rawsize(blob));
+    ssb->sb.st_nlink = 1;
+
+    git_blob_free(blob);
+    if (repo != nullptr) {
+        git_repository_free(repo);
+    }
+
+    return 0;
+}
+
+static php_stream_wrapper_ops wrapper_ops = {
+    wrapper_open,
+    nullptr, // stream_closer
+    nullptr, // stream_stat
+    wrapper_url_stat,
+    nullptr, // dir_opener
+    "git2",
+    nullptr, // unlink
+    nullptr, // rename
+    nullptr, // stream_mkdir
+    nullptr, // stream_rmdir
+    nullptr  // stream_metadata
+};
+
+static php_stream_wrapper wrapper = {
+    &wrapper_ops,
+    nullptr,
+    0
+};
+
+void php_git2::php_git2_register_stream_wrapper()
+{
+    php_register_url_stream_wrapper(GIT2_STREAM_SCHEME,&wrapper);
+}
+
+void php_git2::php_git2_unregister_stream_wrapper()
+{
+    php_unregister_url_stream_wrapper(GIT2_STREAM_SCHEME);
+}
+
+php_stream* php_git2::php_git2_make_blob_stream(zval* owner,git_blob* blob)
+{
+    return blob_stream_create(owner,blob,nullptr);
+}
+
+php_stream* php_git2::php_git2_make_odb_read_stream(zval* owner,git_odb_stream* odbStream)
+{
+    odb_stream_data* data;
+    php_stream* stream;
+
+    if ((odbStream->mode & GIT_STREAM_RDONLY) == 0) {
+        throw php_git2_error_exception("The ODB stream is not readable");
+    }
+
+    data = reinterpret_cast<odb_stream_data*>(emalloc(sizeof(odb_stream_data)));
+    ZVAL_COPY(&data->owner,owner);
+    data->stream = odbStream;
+
+    stream = php_stream_alloc(&odb_stream_ops,data,nullptr,"rb");
+    if (stream == nullptr) {
+        zval_ptr_dtor(&data->owner);
+        efree(data);
+    }
+
+    return stream;
+}
+
+/*
+ * Local Variables:
+ * mode:c++
+ * indent-tabs-mode:nil
+ * tab-width:4
+ * End:
+ */
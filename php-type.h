@@ -801,9 +801,7 @@ namespace php_git2
 
         void ret(zval* return_value)
         {
-            char buf[GIT_OID_HEXSZ + 1];
-            git_oid_tostr(buf,sizeof(buf),&oid);
-            RETVAL_STRING(buf);
+            convert_oid(return_value,&oid);
         }
 
     private:
@@ -855,6 +853,24 @@ namespace php_git2
         }
     };
 
+    // Provide a type for abbreviated OIDs. Prefixes are always parsed as hex
+    // (even when git2.oid_format is "binary") since the prefix length passed
+    // to libgit2 is the string length in hex digits.
+
+    class php_git_oid_prefix_fromhex:
+        virtual public php_string
+    {
+    public:
+        git_oid* byval_git2()
+        {
+            convert_oid_fromhex(&oid,Z_STRVAL(value),Z_STRLEN(value));
+            return &oid;
+        }
+
+    private:
+        git_oid oid;
+    };
+
     // Provide a type for returning an OID value using an out parameter.
 
     class php_git_oid_out:
@@ -928,9 +944,9 @@ namespace php_git2
         {
             array_init(return_value);
             for (size_t i = 0;i < arr.count;++i) {
-                char buf[GIT_OID_HEXSZ + 1];
-                git_oid_tostr(buf,sizeof(buf),arr.ids + i);
-                add_next_index_string(return_value,buf);
+                zval zoid;
+                convert_oid(&zoid,arr.ids + i);
+                add_next_index_zval(return_value,&zoid);
             }
         }
 
@@ -1270,6 +1286,9 @@ namespace php_git2
     using php_git_cred = git2_resource<git_cred>;
     using php_git_submodule = git2_resource<git_submodule>;
     using php_git_worktree = git2_resource<git_worktree>;
+    using php_git_commit_graph = git2_resource<git_commit_graph>;
+    using php_git_commit_graph_writer = git2_resource<git_commit_graph_writer>;
+    using php_git_midx_writer = git2_resource<git_midx_writer>;
 
     // Enumerate nofree alternatives of certain resource types.
 
@@ -165,6 +165,70 @@ static constexpr auto ZIF_GIT_REFDB_SET_BACKEND = zif_php_git2_function<
     php_git2::sequence<1,0>
     >;
 
+static PHP_FUNCTION(git2_refdb_backend_set_cache)
+{
+    php_git2::php_bailer bailer;
+
+    {
+        php_git2::php_object<php_git2::php_refdb_backend_object> backend;
+        php_git2::php_bailout_context ctx(bailer);
+
+        if (BAILOUT_ENTER_REGION(ctx)) {
+            zval* zbackend;
+            zend_long maxRefs;
+            if (zend_parse_parameters(ZEND_NUM_ARGS(),"zl",&zbackend,&maxRefs) == FAILURE) {
+                return;
+            }
+
+            try {
+                backend.parse(zbackend,1);
+
+                if (maxRefs < 0) {
+                    throw php_git2::php_git2_error_exception("Cache size must not be negative");
+                }
+
+                backend.get_storage()->cache.set_capacity(static_cast<size_t>(maxRefs));
+
+            } catch (php_git2::php_git2_exception_base& ex) {
+                php_git2::php_bailout_context ctx2(bailer);
+
+                if (BAILOUT_ENTER_REGION(ctx2)) {
+                    ex.handle();
+                }
+            }
+        }
+    }
+}
+
+static PHP_FUNCTION(git2_refdb_backend_cache_stats)
+{
+    php_git2::php_bailer bailer;
+
+    {
+        php_git2::php_object<php_git2::php_refdb_backend_object> backend;
+        php_git2::php_bailout_context ctx(bailer);
+
+        if (BAILOUT_ENTER_REGION(ctx)) {
+            zval* zbackend;
+            if (zend_parse_parameters(ZEND_NUM_ARGS(),"z",&zbackend) == FAILURE) {
+                return;
+            }
+
+            try {
+                backend.parse(zbackend,1);
+                backend.get_storage()->cache.get_stats(return_value);
+
+            } catch (php_git2::php_git2_exception_base& ex) {
+                php_git2::php_bailout_context ctx2(bailer);
+
+                if (BAILOUT_ENTER_REGION(ctx2)) {
+                    ex.handle();
+                }
+            }
+        }
+    }
+}
+
 // Function entries:
 
 #define GIT_REFDB_FE                                                    \
@@ -173,7 +237,9 @@ static constexpr auto ZIF_GIT_REFDB_SET_BACKEND = zif_php_git2_function<
     PHP_GIT2_FE(git_refdb_free,ZIF_GIT_REFDB_FREE,NULL)                 \
     PHP_GIT2_FE(git_refdb_new,ZIF_GIT_REFDB_NEW,NULL)                   \
     PHP_GIT2_FE(git_refdb_open,ZIF_GIT_REFDB_OPEN,NULL)                 \
-    PHP_GIT2_FE(git_refdb_set_backend,ZIF_GIT_REFDB_SET_BACKEND,NULL)
+    PHP_GIT2_FE(git_refdb_set_backend,ZIF_GIT_REFDB_SET_BACKEND,NULL)   \
+    PHP_FE(git2_refdb_backend_set_cache,NULL)                           \
+    PHP_FE(git2_refdb_backend_cache_stats,NULL)
 
 #endif
 
@@ -49,6 +49,26 @@ namespace php_git2
         git_repository_init_options opts;
     };
 
+    // Provides a repository argument for calls that attach request-scoped
+    // state (e.g. a custom backend) to the repository. Pooled handles outlive
+    // the request, so such calls are refused on them.
+    class php_git_repository_unpooled:
+        public php_resource<php_git_repository>
+    {
+    public:
+        git_repository* byval_git2()
+        {
+            git_repository* repo = php_resource<php_git_repository>::byval_git2();
+
+            if (php_git2_persistent_repository_is_pooled(repo)) {
+                throw php_git2_error_exception(
+                    "Cannot change the backends or namespace of a persistent repository");
+            }
+
+            return repo;
+        }
+    };
+
 } // namespace php_git2
 
 // Functions:
@@ -210,7 +230,7 @@ static constexpr auto ZIF_GIT_REPOSITORY_SET_ODB = zif_php_git2_function<
         git_repository*,
         git_odb*>::func<git_repository_set_odb>,
     php_git2::local_pack<
-        php_git2::php_resource<php_git2::php_git_repository>,
+        php_git2::php_git_repository_unpooled,
         php_git2::php_resource<php_git2::php_git_odb>
         >
     >;
@@ -432,7 +452,7 @@ static constexpr auto ZIF_GIT_REPOSITORY_SET_NAMESPACE = zif_php_git2_function<
         git_repository*,
         const char*>::func<git_repository_set_namespace>,
     php_git2::local_pack<
-        php_git2::php_resource<php_git2::php_git_repository>,
+        php_git2::php_git_repository_unpooled,
         php_git2::php_string
         >
     >;
@@ -529,7 +549,7 @@ static constexpr auto ZIF_GIT_REPOSITORY_SET_CONFIG = zif_php_git2_function<
         git_repository*,
         git_config*>::func<git_repository_set_config>,
     php_git2::local_pack<
-        php_git2::php_resource<php_git2::php_git_repository>,
+        php_git2::php_git_repository_unpooled,
         php_git2::php_resource<php_git2::php_git_config>
         >
     >;
@@ -580,7 +600,7 @@ static constexpr auto ZIF_GIT_REPOSITORY_SET_REFDB = zif_php_git2_function<
         git_repository*,
         git_refdb*>::func<git_repository_set_refdb>,
     php_git2::local_pack<
-        php_git2::php_resource<php_git2::php_git_repository>,
+        php_git2::php_git_repository_unpooled,
         php_git2::php_resource<php_git2::php_git_refdb>
         >
     >;
@@ -617,6 +637,56 @@ static constexpr auto ZIF_GIT_REPOSITORY_MERGEHEAD_FOREACH = zif_php_git2_functi
     php_git2::sequence<0,1,2>
     >;
 
+static PHP_FUNCTION(git2_repository_open_persistent)
+{
+    php_git2::php_bailer bailer;
+
+    {
+        git_repository* repo;
+        php_git2::php_git_repository* rsrc;
+        php_git2::php_bailout_context ctx(bailer);
+
+        if (BAILOUT_ENTER_REGION(ctx)) {
+            char* path;
+            size_t pathlen;
+            if (zend_parse_parameters(ZEND_NUM_ARGS(),"s",&path,&pathlen) == FAILURE) {
+                return;
+            }
+
+            try {
+                // If the pool is disabled, fall back to a normal, request-scoped
+                // repository handle.
+                if (GIT2_G(persistentReposMax) <= 0) {
+                    int retval = git_repository_open(&repo,path);
+                    if (retval < 0) {
+                        php_git2::git_error(retval);
+                    }
+
+                    rsrc = php_git2::php_git2_create_resource<php_git2::php_git_repository>();
+                }
+                else {
+                    // The pool owns the handle, so the resource must never free
+                    // it.
+                    repo = php_git2::php_git2_persistent_repository_open(path,pathlen);
+                    rsrc = php_git2::php_git2_create_resource<php_git2::php_git_repository_nofree>();
+                }
+
+            } catch (php_git2::php_git2_exception_base& ex) {
+                php_git2::php_bailout_context ctx2(bailer);
+
+                if (BAILOUT_ENTER_REGION(ctx2)) {
+                    ex.handle();
+                }
+
+                return;
+            }
+
+            rsrc->set_handle(repo);
+            RETVAL_RES(zend_register_resource(rsrc,php_git2::php_git_repository::resource_le()));
+        }
+    }
+}
+
 // Function Entries:
 
 #define GIT_REPOSITORY_FE                                               \
@@ -664,7 +734,8 @@ static constexpr auto ZIF_GIT_REPOSITORY_MERGEHEAD_FOREACH = zif_php_git2_functi
     PHP_GIT2_FE(git_repository_refdb,ZIF_GIT_REPOSITORY_REFDB,NULL)     \
     PHP_GIT2_FE(git_repository_set_refdb,ZIF_GIT_REPOSITORY_SET_REFDB,NULL) \
     PHP_GIT2_FE(git_repository_fetchhead_foreach,ZIF_GIT_REPOSITORY_FETCHHEAD_FOREACH,NULL) \
-    PHP_GIT2_FE(git_repository_mergehead_foreach,ZIF_GIT_REPOSITORY_MERGEHEAD_FOREACH,NULL)
+    PHP_GIT2_FE(git_repository_mergehead_foreach,ZIF_GIT_REPOSITORY_MERGEHEAD_FOREACH,NULL) \
+    PHP_FE(git2_repository_open_persistent,NULL)
 
 #endif
 
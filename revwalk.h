@@ -71,6 +71,61 @@ namespace php_git2
         php_callback_sync* cb;
     };
 
+    // Retrieves up to 'max' OIDs from a revwalk. This is the implementation of
+    // git2_revwalk_next_many().
+
+    inline void php_git2_revwalk_next_many(zval* return_value,
+        git_revwalk* walk,
+        zend_long max,
+        bool binary)
+    {
+        int retval = 0;
+        zend_long n = 0;
+        git_oid oid;
+        smart_str buf = {0};
+
+        if (max <= 0) {
+            throw php_git2_error_exception("Maximum number of OIDs must be greater than zero");
+        }
+
+        if (!binary) {
+            array_init_size(return_value,static_cast<uint32_t>(max < 1024 ? max : 1024));
+        }
+
+        while (n < max && (retval = git_revwalk_next(&oid,walk)) == 0) {
+            if (binary) {
+                smart_str_appendl(&buf,reinterpret_cast<const char*>(oid.id),GIT_OID_RAWSZ);
+            }
+            else {
+                zval zoid;
+
+                convert_oid(&zoid,&oid);
+                add_next_index_zval(return_value,&zoid);
+            }
+
+            n += 1;
+        }
+
+        if (retval < 0 && retval != GIT_ITEROVER) {
+            smart_str_free(&buf);
+            git_error(retval);
+        }
+
+        // Return false once the walk is exhausted (like git_revwalk_next()).
+
+        if (n == 0) {
+            if (!binary) {
+                zval_ptr_dtor(return_value);
+            }
+
+            RETVAL_FALSE;
+        }
+        else if (binary) {
+            smart_str_0(&buf);
+            RETVAL_STR(buf.s);
+        }
+    }
+
 } // namespace php_git2
 
 // Functions:
@@ -264,6 +319,37 @@ static constexpr auto ZIF_GIT_REVWALK_SIMPLIFY_FIRST_PARENT = zif_php_git2_funct
         >
     >;
 
+static PHP_FUNCTION(git2_revwalk_next_many)
+{
+    php_git2::php_bailer bailer;
+
+    {
+        php_git2::php_resource<php_git2::php_git_revwalk> walk;
+        php_git2::php_bailout_context ctx(bailer);
+
+        if (BAILOUT_ENTER_REGION(ctx)) {
+            zval* zvp;
+            zend_long max;
+            zend_bool binary = 0;
+            if (zend_parse_parameters(ZEND_NUM_ARGS(),"zl|b",&zvp,&max,&binary) == FAILURE) {
+                return;
+            }
+
+            try {
+                walk.parse(zvp,1);
+                php_git2::php_git2_revwalk_next_many(return_value,walk.byval_git2(),max,binary);
+
+            } catch (php_git2::php_git2_exception_base& ex) {
+                php_git2::php_bailout_context ctx2(bailer);
+
+                if (BAILOUT_ENTER_REGION(ctx2)) {
+                    ex.handle();
+                }
+            }
+        }
+    }
+}
+
 // Function Entries:
 
 #define GIT_REVWALK_FE                                              \
@@ -283,7 +369,8 @@ static constexpr auto ZIF_GIT_REVWALK_SIMPLIFY_FIRST_PARENT = zif_php_git2_funct
     PHP_GIT2_FE(git_revwalk_push_range,ZIF_GIT_REVWALK_PUSH_RANGE,NULL) \
     PHP_GIT2_FE(git_revwalk_push_ref,ZIF_GIT_REVWALK_PUSH_REF,NULL)     \
     PHP_GIT2_FE(git_revwalk_repository,ZIF_GIT_REVWALK_REPOSITORY,NULL) \
-    PHP_GIT2_FE(git_revwalk_simplify_first_parent,ZIF_GIT_REVWALK_SIMPLIFY_FIRST_PARENT,NULL)
+    PHP_GIT2_FE(git_revwalk_simplify_first_parent,ZIF_GIT_REVWALK_SIMPLIFY_FIRST_PARENT,NULL) \
+    PHP_FE(git2_revwalk_next_many,NULL)
 
 #endif
 
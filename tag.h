@@ -132,8 +132,8 @@ static constexpr auto ZIF_GIT_TAG_LOOKUP_PREFIX = zif_php_git2_function_setdeps<
         php_git2::php_resource_ref<php_git2::php_git_tag>,
         php_git2::php_resource<php_git2::php_git_repository>,
         php_git2::connector_wrapper<php_git2::php_string_length_connector<
-                                        size_t,php_git2::php_git_oid_fromstr> >,
-        php_git2::php_git_oid_fromstr
+                                        size_t,php_git2::php_git_oid_prefix_fromhex> >,
+        php_git2::php_git_oid_prefix_fromhex
         >,
     php_git2::sequence<0,1>,
     1,
@@ -0,0 +1,90 @@
+<?php
+
+/**
+ * Shared helpers for the php-git2 micro-benchmarks.
+ *
+ * Each benchmark script registers a set of named cases. A case is a callable
+ * that performs one unit of work and returns the number of operations it
+ * performed. Results are reported as nanoseconds per operation.
+ *
+ * Common options:
+ *   --iterations=N   Number of times each case is run (default 20)
+ *   --json=FILE      Write results to FILE
+ *   --compare=FILE   Compare results against a previous --json run
+ */
+
+function bench_options(array $argv) : array {
+    $opts = [
+        'iterations' => 20,
+        'json' => null,
+        'compare' => null,
+    ];
+
+    foreach (array_slice($argv,1) as $arg) {
+        if (preg_match('/^--([a-z]+)=(.*)$/',$arg,$match)
+            && array_key_exists($match[1],$opts))
+        {
+            $opts[$match[1]] = $match[2];
+        }
+    }
+
+    $opts['iterations'] = max(1,(int)$opts['iterations']);
+
+    return $opts;
+}
+
+function bench_make_repo(string $name) : string {
+    $dir = sys_get_temp_dir() . DIRECTORY_SEPARATOR . 'php-git2-bench-' . $name;
+    if (!is_dir($dir)) {
+        $opts = [
+            'bare' => false,
+            'local' => GIT_CLONE_LOCAL,
+        ];
+
+        $src = __DIR__ . '/../repos/general.git';
+        git_repository_free(git_clone($src,$dir,$opts));
+    }
+
+    return $dir;
+}
+
+function bench_run(array $cases,array $opts) : array {
+    $results = [];
+
+    foreach ($cases as $name => $case) {
+        // Warm up once so that libgit2 caches are populated.
+        $case();
+
+        $ops = 0;
+        $start = hrtime(true);
+        for ($i = 0;$i < $opts['iterations'];++$i) {
+            $ops += $case();
+        }
+        $elapsed = hrtime(true) - $start;
+
+        $results[$name] = $ops > 0 ? $elapsed / $ops : 0.0;
+    }
+
+    return $results;
+}
+
+function bench_report(array $results,array $opts) : void {
+    $baseline = null;
+    if (isset($opts['compare'])) {
+        $baseline = json_decode(file_get_contents($opts['compare']),true);
+    }
+
+    foreach ($results as $name => $nsPerOp) {
+        $line = sprintf('%-32s %12.1f ns/op',$name,$nsPerOp);
+        if (isset($baseline[$name]) && $baseline[$name] > 0) {
+            $line .= sprintf('  (before %.1f ns/op, %+.1f%%)',
+                             $baseline[$name],
+                             ($nsPerOp - $baseline[$name]) / $baseline[$name] * 100);
+        }
+        echo "$line\n";
+    }
+
+    if (isset($opts['json'])) {
+        file_put_contents($opts['json'],json_encode($results,JSON_PRETTY_PRINT));
+    }
+}
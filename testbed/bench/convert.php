@@ -0,0 +1,125 @@
+<?php
+
+/**
+ * Benchmarks the conversion of libgit2 structures to PHP arrays (i.e. the
+ * convert_* helpers) for each structure type.
+ *
+ * To compare two builds, run the script against the first build with
+ * --json=before.json and then against the second with --compare=before.json:
+ *
+ *   php -c ../php.ini convert.php --json=before.json
+ *   php -c ../php.ini convert.php --compare=before.json
+ */
+
+require_once(__DIR__ . '/bench.php');
+
+$opts = bench_options($argv);
+$path = bench_make_repo('convert');
+$repo = git_repository_open($path);
+
+// Diff the root commit against HEAD so we have a reasonably sized diff.
+$walk = git_revwalk_new($repo);
+git_revwalk_push_head($walk);
+git_revwalk_sorting($walk,GIT_SORT_TIME);
+$oids = [];
+while (($oid = git_revwalk_next($walk)) !== false) {
+    $oids[] = $oid;
+}
+
+$newTree = git_commit_tree(git_commit_lookup($repo,$oids[0]));
+$oldTree = git_commit_tree(git_commit_lookup($repo,$oids[count($oids)-1]));
+$diff = git_diff_tree_to_tree($repo,$oldTree,$newTree,null);
+$ndeltas = git_diff_num_deltas($diff);
+
+$patches = [];
+for ($i = 0;$i < $ndeltas;++$i) {
+    $patch = git_patch_from_diff($diff,$i);
+    if (is_resource($patch) && git_patch_num_hunks($patch) > 0) {
+        $patches[] = $patch;
+    }
+}
+
+$commits = array_map(function($oid) use($repo) {
+    return git_commit_author(git_commit_lookup($repo,$oid));
+},$oids);
+
+$index = git_repository_index($repo);
+$status = git_status_list_new($repo,['flags' => GIT_STATUS_OPT_INCLUDE_UNMODIFIED]);
+$reflog = git_reflog_read($repo,'HEAD');
+
+$blameFile = null;
+for ($i = 0;$i < git_index_entrycount($index);++$i) {
+    $ent = git_index_get_byindex($index,$i);
+    if ($ent['mode'] == 0100644) {
+        $blameFile = $ent['path'];
+        break;
+    }
+}
+$blame = git_blame_file($repo,$blameFile,null);
+
+$cases = [
+    'git_diff_delta' => function() use($diff,$ndeltas) {
+        for ($i = 0;$i < $ndeltas;++$i) {
+            git_diff_get_delta($diff,$i);
+        }
+        return $ndeltas;
+    },
+    'git_diff_hunk' => function() use($patches) {
+        $n = 0;
+        foreach ($patches as $patch) {
+            $count = git_patch_num_hunks($patch);
+            for ($i = 0;$i < $count;++$i) {
+                git_patch_get_hunk($lines,$patch,$i);
+            }
+            $n += $count;
+        }
+        return $n;
+    },
+    'git_diff_line' => function() use($patches) {
+        $n = 0;
+        foreach ($patches as $patch) {
+            $count = git_patch_num_lines_in_hunk($patch,0);
+            for ($i = 0;$i < $count;++$i) {
+                git_patch_get_line_in_hunk($patch,0,$i);
+            }
+            $n += $count;
+        }
+        return $n;
+    },
+    'git_signature' => function() use($commits) {
+        foreach ($commits as $sig) {
+            git2_signature_convert($sig);
+        }
+        return count($commits);
+    },
+    'git_index_entry' => function() use($index) {
+        $count = git_index_entrycount($index);
+        for ($i = 0;$i < $count;++$i) {
+            git_index_get_byindex($index,$i);
+        }
+        return $count;
+    },
+    'git_status_entry' => function() use($status) {
+        $count = git_status_list_entrycount($status);
+        for ($i = 0;$i < $count;++$i) {
+            git_status_byindex($status,$i);
+        }
+        return $count;
+    },
+    'git_blame_hunk' => function() use($blame) {
+        $count = git_blame_get_hunk_count($blame);
+        for ($i = 0;$i < $count;++$i) {
+            git_blame_get_hunk_byindex($blame,$i);
+        }
+        return $count;
+    },
+    'git_reflog_entry' => function() use($reflog) {
+        $count = git_reflog_entrycount($reflog);
+        for ($i = 0;$i < $count;++$i) {
+            git_reflog_entry_byindex($reflog,$i);
+        }
+        return $count;
+    },
+];
+
+bench_report(bench_run($cases,$opts),$opts);
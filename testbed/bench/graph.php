@@ -0,0 +1,68 @@
+<?php
+
+/**
+ * Benchmarks history queries (topological revwalk, merge base and
+ * ahead/behind) with and without a commit-graph attached to the ODB.
+ *
+ *   php -c ../php.ini graph.php
+ */
+
+require_once(__DIR__ . '/bench.php');
+
+$opts = bench_options($argv);
+$path = bench_make_repo('graph');
+
+// Make sure the clone has an up-to-date commit-graph file.
+$repo = git_repository_open($path);
+git2_commit_graph_update($repo,true);
+git_repository_free($repo);
+
+function bench_graph_cases(string $path,bool $useGraph) : array {
+    $repo = git_repository_open($path);
+    if ($useGraph) {
+        $odb = git_repository_odb($repo);
+        $objectsDir = git_repository_path($repo) . 'objects';
+        git_odb_set_commit_graph($odb,git_commit_graph_open($objectsDir));
+    }
+
+    $walk = git_revwalk_new($repo);
+    git_revwalk_push_head($walk);
+    git_revwalk_sorting($walk,GIT_SORT_TIME);
+    $oids = [];
+    while (($oid = git_revwalk_next($walk)) !== false) {
+        $oids[] = $oid;
+    }
+
+    $head = $oids[0];
+    $tail = $oids[count($oids)-1];
+    $middle = $oids[intdiv(count($oids),2)];
+    $suffix = $useGraph ? ' (graph)' : '';
+
+    return [
+        'revwalk_topo' . $suffix => function() use($repo) {
+            $walk = git_revwalk_new($repo);
+            git_revwalk_sorting($walk,GIT_SORT_TOPOLOGICAL);
+            git_revwalk_push_glob($walk,'refs/*');
+            $n = 0;
+            while (git_revwalk_next($walk) !== false) {
+                $n += 1;
+            }
+            return $n;
+        },
+        'merge_base' . $suffix => function() use($repo,$head,$middle) {
+            git_merge_base($repo,$head,$middle);
+            return 1;
+        },
+        'ahead_behind' . $suffix => function() use($repo,$head,$tail) {
+            git_graph_ahead_behind($behind,$repo,$head,$tail);
+            return 1;
+        },
+    ];
+}
+
+$cases = array_merge(
+    bench_graph_cases($path,false),
+    bench_graph_cases($path,true)
+);
+
+bench_report(bench_run($cases,$opts),$opts);
@@ -108,7 +108,16 @@ class PHPSerializedConfigBackend extends \GitConfigBackend {
     }
 
     public function iterator_new() {
-        $this->iterator = $this->storage;
+        $this->iterator = [];
+        foreach ($this->storage as $name => $values) {
+            foreach ($values as $value) {
+                $this->iterator[] = [
+                    'name' => $name,
+                    'value' => $value,
+                    'level' => $this->level,
+                ];
+            }
+        }
     }
 
     public function iterator_next($context) {
@@ -116,10 +125,10 @@ class PHPSerializedConfigBackend extends \GitConfigBackend {
             return false;
         }
 
-        $value = current($this->iterator);
+        $entry = current($this->iterator);
         next($this->iterator);
 
-        return $value[0];
+        return $entry;
     }
 
     public function snapshot() {
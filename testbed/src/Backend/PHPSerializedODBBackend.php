@@ -71,7 +71,30 @@ class PHPSerializedODBBackend extends \GitODBBackend {
         }
 
         $size = strlen($this->storage[$oid]['d']);
-        $type = strlen($this->storage[$oid]['t']);
+        $type = $this->storage[$oid]['t'];
+    }
+
+    /**
+     * Implements GitODBBackend::read_many().
+     *
+     * @param array $oids
+     *  The IDs of the objects to read.
+     *
+     * @return array
+     *  Maps each OID that was found to an array with 'type' and 'data' keys.
+     */
+    public function read_many(array $oids) {
+        $result = [];
+        foreach ($oids as $oid) {
+            if (isset($this->storage[$oid])) {
+                $result[$oid] = [
+                    'type' => $this->storage[$oid]['t'],
+                    'data' => $this->storage[$oid]['d'],
+                ];
+            }
+        }
+
+        return $result;
     }
 
     /**
@@ -57,6 +57,35 @@ class SQLiteODBBackend extends \GitODBBackend {
         return $arr[1];
     }
 
+    /**
+     * Implements GitODBBackend::read_many().
+     *
+     * @param array $oids
+     *  The IDs of the objects to read.
+     *
+     * @return array
+     *  Maps each OID that was found to an array with 'type' and 'data' keys.
+     */
+    public function read_many(array $oids) : array {
+        $params = implode(',',array_fill(0,count($oids),'?'));
+        $stmt = $this->conn->prepare("SELECT oid,type,data FROM odb WHERE oid IN ($params)");
+        foreach (array_values($oids) as $i => $oid) {
+            $stmt->bindValue($i + 1,$oid,SQLITE3_TEXT);
+        }
+
+        $objects = [];
+        $result = $stmt->execute();
+        while (($row = $result->fetchArray(SQLITE3_NUM)) !== false) {
+            $objects[$row[0]] = [
+                'type' => $row[1],
+                'data' => $row[2],
+            ];
+        }
+        $stmt->close();
+
+        return $objects;
+    }
+
     /**
      * Implements GitODBBackend::write().
      *
@@ -75,6 +104,35 @@ class SQLiteODBBackend extends \GitODBBackend {
         $this->stmt['write']->reset();
     }
 
+    /**
+     * Implements GitODBBackend::begin_batch().
+     */
+    public function begin_batch() : void {
+        $this->conn->exec('BEGIN');
+    }
+
+    /**
+     * Implements GitODBBackend::write_batch().
+     *
+     * @param array $objects
+     *  Maps OID to an array with 'type' and 'data' keys.
+     */
+    public function write_batch(array $objects) : void {
+        foreach ($objects as $oid => $object) {
+            $this->write($oid,$object['data'],$object['type']);
+        }
+    }
+
+    /**
+     * Implements GitODBBackend::end_batch().
+     *
+     * @param bool $success
+     *  Whether write_batch() succeeded.
+     */
+    public function end_batch(bool $success) : void {
+        $this->conn->exec($success ? 'COMMIT' : 'ROLLBACK');
+    }
+
     /**
      * Implements GitODBBackend::exists().
      *
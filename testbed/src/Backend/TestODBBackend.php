@@ -29,6 +29,12 @@ class TestODBBackend extends PHPSerializedODBBackend {
         return parent::read_header($size,$type,$oid);
     }
 
+    public function read_many(array $oids) {
+        $this->called[] = 'read_many';
+        $this->unit->assertNotEmpty($oids);
+        return parent::read_many($oids);
+    }
+
     public function write($oid,$data,$type) {
         $this->called[] = 'write';
         $this->unit->assertIsString($oid);
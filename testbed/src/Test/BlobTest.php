@@ -163,6 +163,46 @@ final class BlobTest extends RepositoryTestCase {
         $this->assertIsInt($result);
     }
 
+    /**
+     * @depends testLookup
+     * @phpGitTest git2_blob_stream
+     */
+    public function testBlobStream($blob) {
+        $stream = git2_blob_stream($blob);
+
+        $this->assertIsResource($stream);
+        $this->assertEquals(git_blob_rawcontent($blob),stream_get_contents($stream));
+        $this->assertEquals(git_blob_rawsize($blob),fstat($stream)['size']);
+
+        rewind($stream);
+        $this->assertEquals(substr(git_blob_rawcontent($blob),0,4),fread($stream,4));
+        fclose($stream);
+    }
+
+    /**
+     * @depends testLookup
+     */
+    public function testStreamWrapper($blob) {
+        $repo = static::getRepository();
+        $path = rtrim(git_repository_path($repo),'/');
+        $id = git_blob_id($blob);
+
+        $this->assertContains('git2',stream_get_wrappers());
+        $contents = file_get_contents("git2://$path/$id");
+        $this->assertEquals(git_blob_rawcontent($blob),$contents);
+
+        $object = git_revparse_single($repo,'master:hello.c');
+        $expected = git_blob_rawcontent(git_blob_lookup($repo,git_object_id($object)));
+        $this->assertEquals($expected,file_get_contents("git2://$path/master:hello.c"));
+        $this->assertEquals($expected,file_get_contents("git2://$path/refs/heads/master:hello.c"));
+        $this->assertEquals(strlen($expected),filesize("git2://$path/refs/heads/master:hello.c"));
+
+        $ctx = stream_context_create(['git2' => ['persistent' => true]]);
+        $this->assertEquals($expected,file_get_contents("git2://$path/HEAD:hello.c",false,$ctx));
+
+        $this->assertFalse(@file_get_contents("git2://$path/does-not-exist:nope"));
+    }
+
     /**
      * @phpGitTest git_blob_lookup_prefix
      */
@@ -0,0 +1,129 @@
+<?php
+
+namespace PhpGit2\Test;
+
+use PhpGit2\RepositoryBareTestCase;
+
+final class CommitGraphTest extends RepositoryBareTestCase {
+    /**
+     * @phpGitTest git_commit_graph_open
+     */
+    public function testOpen() {
+        $path = static::makePath('repo.git','objects');
+        $result = git_commit_graph_open($path);
+
+        $this->assertResourceHasType($result,'git_commit_graph');
+
+        return $result;
+    }
+
+    /**
+     * @phpGitTest git_commit_graph_free
+     */
+    public function testFree() {
+        $cgraph = git_commit_graph_open(static::makePath('repo.git','objects'));
+        $result = git_commit_graph_free($cgraph);
+
+        $this->assertNull($result);
+        $this->assertResourceHasType($cgraph,'Unknown');
+    }
+
+    /**
+     * @depends testOpen
+     * @phpGitTest git_odb_set_commit_graph
+     */
+    public function testOdbSetCommitGraph($cgraph) {
+        $odb = git_repository_odb(static::getRepository());
+        $result = git_odb_set_commit_graph($odb,$cgraph);
+
+        $this->assertNull($result);
+    }
+
+    /**
+     * @phpGitTest git_commit_graph_writer_new
+     */
+    public function testWriterNew() {
+        $path = static::makePath('repo.git','objects','info');
+        $result = git_commit_graph_writer_new($path);
+
+        $this->assertResourceHasType($result,'git_commit_graph_writer');
+
+        return $result;
+    }
+
+    /**
+     * @depends testWriterNew
+     * @phpGitTest git_commit_graph_writer_add_revwalk
+     */
+    public function testWriterAddRevwalk($writer) {
+        $walk = git_revwalk_new(static::getRepository());
+        git_revwalk_push_glob($walk,'refs/*');
+        $result = git_commit_graph_writer_add_revwalk($writer,$walk);
+
+        $this->assertNull($result);
+
+        return $writer;
+    }
+
+    /**
+     * @phpGitTest git_commit_graph_writer_add_index_file
+     */
+    public function testWriterAddIndexFile() {
+        $writer = git_commit_graph_writer_new(static::makePath('repo.git','objects','info'));
+        $packs = glob(static::makePath('repo.git','objects','pack','*.idx'));
+        $result = git_commit_graph_writer_add_index_file(
+            $writer,
+            static::getRepository(),
+            $packs[0]
+        );
+
+        $this->assertNull($result);
+    }
+
+    /**
+     * @depends testWriterAddRevwalk
+     * @phpGitTest git_commit_graph_writer_dump
+     */
+    public function testWriterDump($writer) {
+        $result = git_commit_graph_writer_dump($writer,null);
+
+        $this->assertIsString($result);
+        $this->assertSame('CGPH',substr($result,0,4));
+
+        return $writer;
+    }
+
+    /**
+     * @depends testWriterDump
+     * @phpGitTest git_commit_graph_writer_commit
+     */
+    public function testWriterCommit($writer) {
+        $result = git_commit_graph_writer_commit($writer,null);
+
+        $this->assertNull($result);
+        $this->assertFileExists(static::makePath('repo.git','objects','info','commit-graph'));
+
+        return $writer;
+    }
+
+    /**
+     * @depends testWriterCommit
+     * @phpGitTest git_commit_graph_writer_free
+     */
+    public function testWriterFree($writer) {
+        $result = git_commit_graph_writer_free($writer);
+
+        $this->assertNull($result);
+        $this->assertResourceHasType($writer,'Unknown');
+    }
+
+    /**
+     * @phpGitTest git2_commit_graph_update
+     */
+    public function testUpdate() {
+        $repo = static::getRepository();
+
+        $this->assertTrue(git2_commit_graph_update($repo,true));
+        $this->assertFalse(git2_commit_graph_update($repo));
+    }
+}
@@ -417,6 +417,51 @@ final class CommitTest extends RepositoryBareTestCase {
         return $result;
     }
 
+    /**
+     * @depends testLookup
+     * @phpGitTest git2_commit_info
+     */
+    public function testInfo($commit) {
+        $result = git2_commit_info($commit);
+
+        $this->assertIsArray($result);
+        $this->assertSame(git_commit_id($commit),$result['id']);
+        $this->assertSame(git_commit_tree_id($commit),$result['tree_id']);
+        $this->assertIsArray($result['parent_ids']);
+        $this->assertIsArray($result['author']);
+        $this->assertIsString($result['message']);
+        $this->assertIsInt($result['time']);
+
+        $repo = static::getRepository();
+        $id = '2cd82ceaee5897c72eb8fded83632569c80c69c5';
+        $result = git2_commit_info($repo,$id,GIT2_COMMIT_INFO_ID | GIT2_COMMIT_INFO_SUMMARY);
+
+        $this->assertSame(['id','summary'],array_keys($result));
+        $this->assertSame($id,$result['id']);
+    }
+
+    /**
+     * @phpGitTest git2_commit_info_many
+     */
+    public function testInfoMany() {
+        $repo = static::getRepository();
+        $ids = [
+            '2cd82ceaee5897c72eb8fded83632569c80c69c5',
+            '0ba6992f3e37531e49ceb230b77537a6439ae08a',
+        ];
+        $result = git2_commit_info_many($repo,$ids);
+
+        $this->assertCount(2,$result);
+        $this->assertSame($ids[0],$result[0]['id']);
+        $this->assertSame($ids[1],$result[1]['id']);
+        $this->assertIsArray($result[0]['author']);
+
+        $result = git2_commit_info_many($repo,$ids,GIT2_COMMIT_INFO_ID | GIT2_COMMIT_INFO_TIME,true);
+
+        $this->assertSame(['id','time','time_offset'],array_keys($result));
+        $this->assertSame($ids,$result['id']);
+    }
+
     /**
      * @depends testLookupPrefix
      * @phpGitTest git_commit_free
@@ -110,4 +110,38 @@ final class CustomConfigBackendTest extends RepositoryBareTestCase {
         $this->assertTrue($backend->wasCalled('open'));
         $this->assertTrue($backend->wasCalled('del'));
     }
+
+    /**
+     * @depends testWrite
+     */
+    public function testCache() {
+        $repo = static::getRepository();
+        $cfg = git_config_new();
+        git_repository_set_config($repo,$cfg);
+
+        $backend = new TestConfigBackend($this);
+        git2_config_backend_set_cache($backend,true);
+        git_config_add_backend($cfg,$backend,GIT_CONFIG_HIGHEST_LEVEL,$repo,false);
+
+        $this->assertTrue($backend->wasCalled('iterator_next'));
+
+        $value = git_config_get_int32($cfg,'test.int321');
+        $this->assertEquals(33,$value);
+        $value = git_config_get_string($cfg,'test.string2');
+        $this->assertEquals('monolithic_lego',$value);
+
+        $stats = git2_config_backend_cache_stats($backend);
+        $this->assertFalse($backend->wasCalled('get'));
+        $this->assertSame(1,$stats['loads']);
+        $this->assertSame(2,$stats['hits']);
+
+        // Writing through the backend reloads the entries.
+        git_config_set_string($cfg,'test.string3','cached');
+        $value = git_config_get_string($cfg,'test.string3');
+        $this->assertEquals('cached',$value);
+
+        $stats = git2_config_backend_cache_stats($backend);
+        $this->assertFalse($backend->wasCalled('get'));
+        $this->assertSame(2,$stats['loads']);
+    }
 }
@@ -3,6 +3,7 @@
 namespace PhpGit2\Test;
 
 use PhpGit2\RepositoryBareTestCase;
+use PhpGit2\Backend\PHPSerializedODBBackend;
 use PhpGit2\Backend\TestODBBackend;
 use PhpGit2\Callback\CallbackPayload;
 
@@ -123,4 +124,220 @@ EOF;
 
         $this->assertTrue($backend->wasCalled('for_each'));
     }
+
+    /**
+     *
+     */
+    public function testCache() {
+        $repo = git_repository_new();
+        $odb = git_odb_new();
+        $backend = new TestODBBackend($this);
+
+        git2_odb_backend_set_cache($backend,1 << 20);
+        git_odb_add_backend($odb,$backend,1);
+        git_repository_set_odb($repo,$odb);
+
+        $data = 'The quick brown fox jumps over the lazy dog.';
+        $oid = git_blob_create_frombuffer($repo,$data);
+
+        $first = git_odb_object_data(git_odb_read($odb,$oid));
+        $stats = git2_odb_backend_cache_stats($backend);
+
+        $this->assertSame($data,$first);
+        $this->assertSame(1 << 20,$stats['capacity']);
+        $this->assertSame(1,$stats['entries']);
+        $this->assertGreaterThan(strlen($data),$stats['bytes']);
+
+        $second = git_odb_object_data(git_odb_read($odb,$oid));
+        $size = git_odb_read_header($type,$odb,$oid);
+        $result = git2_odb_backend_cache_stats($backend);
+
+        $this->assertSame($data,$second);
+        $this->assertSame(strlen($data),$size);
+        $this->assertSame(GIT_OBJ_BLOB,$type);
+        $this->assertSame($stats['hits'] + 2,$result['hits']);
+        $this->assertFalse($backend->wasCalled('read_header'));
+
+        git2_odb_backend_set_cache($backend,0);
+        $result = git2_odb_backend_cache_stats($backend);
+
+        $this->assertSame(0,$result['entries']);
+        $this->assertSame(0,$result['bytes']);
+    }
+
+    /**
+     *
+     */
+    public function testCacheRejectsInternalBackend() {
+        $path = static::makeDirectory('odb','cache-internal');
+        $loose = git_odb_backend_loose($path,5,false,0700,0600);
+
+        $this->expectException(\Git2Exception::class);
+        git2_odb_backend_set_cache($loose,1 << 20);
+    }
+
+    /**
+     *
+     */
+    public function testReadMany() {
+        $repo = git_repository_new();
+        $odb = git_odb_new();
+        $backend = new TestODBBackend($this);
+
+        git_odb_add_backend($odb,$backend,1);
+        git_repository_set_odb($repo,$odb);
+
+        $blob = git_blob_create_frombuffer($repo,'prefetched');
+
+        $builder = git_treebuilder_new($repo,null);
+        git_treebuilder_insert($builder,'file.txt',$blob,GIT_FILEMODE_BLOB);
+        $subtree = git_treebuilder_write($builder);
+
+        $builder = git_treebuilder_new($repo,null);
+        git_treebuilder_insert($builder,'dir',$subtree,GIT_FILEMODE_TREE);
+        $root = git_treebuilder_write($builder);
+
+        // Reading the root tree prefetches its subtree.
+        git_odb_read($odb,$root);
+        $stats = git2_odb_backend_cache_stats($backend);
+
+        $this->assertTrue($backend->wasCalled('read_many'));
+        $this->assertSame(1,$stats['prefetch']['entries']);
+
+        $obj = git_odb_read($odb,$subtree);
+        $result = git2_odb_backend_cache_stats($backend);
+
+        $this->assertSame(GIT_OBJ_TREE,git_odb_object_type($obj));
+        $this->assertSame($stats['prefetch']['hits'] + 1,$result['prefetch']['hits']);
+        $this->assertSame(0,$result['prefetch']['entries']);
+    }
+
+    /**
+     *
+     */
+    public function testReadManyFailure() {
+        $repo = git_repository_new();
+        $odb = git_odb_new();
+        $backend = new class extends PHPSerializedODBBackend {
+            public function read_many(array $oids) {
+                throw new \Exception('read_many failed');
+            }
+        };
+
+        git_odb_add_backend($odb,$backend,1);
+        git_repository_set_odb($repo,$odb);
+
+        $blob = git_blob_create_frombuffer($repo,'not prefetched');
+
+        $builder = git_treebuilder_new($repo,null);
+        git_treebuilder_insert($builder,'file.txt',$blob,GIT_FILEMODE_BLOB);
+        $subtree = git_treebuilder_write($builder);
+
+        $builder = git_treebuilder_new($repo,null);
+        git_treebuilder_insert($builder,'dir',$subtree,GIT_FILEMODE_TREE);
+        $root = git_treebuilder_write($builder);
+
+        // A failed prefetch does not fail the read.
+        $obj = git_odb_read($odb,$root);
+
+        $this->assertSame(GIT_OBJ_TREE,git_odb_object_type($obj));
+    }
+
+    /**
+     *
+     */
+    public function testWriteBatch() {
+        $repo = git_repository_new();
+        $odb = git_odb_new();
+        $backend = new class extends PHPSerializedODBBackend {
+            public $events = [];
+
+            public function begin_batch() {
+                $this->events[] = 'begin';
+            }
+
+            public function write_batch(array $objects) {
+                $this->events[] = count($objects);
+                foreach ($objects as $oid => $object) {
+                    $this->write($oid,$object['data'],$object['type']);
+                }
+            }
+
+            public function end_batch($success) {
+                $this->events[] = $success ? 'end' : 'abort';
+            }
+        };
+
+        git_odb_add_backend($odb,$backend,1);
+        git_repository_set_odb($repo,$odb);
+
+        $blob = git_blob_create_frombuffer($repo,'batched');
+
+        $this->assertSame(['begin',1,'end'],$backend->events);
+        $this->assertTrue($backend->exists($blob));
+
+        $index = git_index_new();
+        git_index_add($index,[
+            'id' => $blob,
+            'path' => 'a/b/c.txt',
+            'mode' => GIT_FILEMODE_BLOB,
+        ]);
+
+        // The three trees are written in a single batch.
+        $backend->events = [];
+        $tree = git_index_write_tree_to($index,$repo);
+
+        $this->assertSame(['begin',3,'end'],$backend->events);
+        $this->assertTrue($backend->exists($tree));
+    }
+
+    /**
+     *
+     */
+    public function testWriteBatchFailure() {
+        $repo = git_repository_new();
+        $odb = git_odb_new();
+        $backend = new class extends PHPSerializedODBBackend {
+            public $events = [];
+            public $fail = true;
+
+            public function begin_batch() {
+                $this->events[] = 'begin';
+            }
+
+            public function write_batch(array $objects) {
+                $this->events[] = count($objects);
+                if ($this->fail) {
+                    throw new \Exception('write_batch failed');
+                }
+                foreach ($objects as $oid => $object) {
+                    $this->write($oid,$object['data'],$object['type']);
+                }
+            }
+
+            public function end_batch($success) {
+                $this->events[] = $success ? 'end' : 'abort';
+            }
+        };
+
+        git_odb_add_backend($odb,$backend,1);
+        git_repository_set_odb($repo,$odb);
+
+        try {
+            git_blob_create_frombuffer($repo,'first');
+            $this->fail('Expected the failed batch to raise an exception');
+        } catch (\Exception $ex) {
+            $this->assertSame('write_batch failed',$ex->getMessage());
+        }
+
+        $this->assertSame(['begin',1,'abort'],$backend->events);
+
+        // The object of the failed batch is passed again with the next batch.
+        $backend->events = [];
+        $backend->fail = false;
+        $blob = git_blob_create_frombuffer($repo,'second');
+
+        $this->assertSame(['begin',2,'end'],$backend->events);
+        $this->assertTrue($backend->exists($blob));
+    }
 }
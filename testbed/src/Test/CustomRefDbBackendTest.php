@@ -4,6 +4,7 @@ namespace PhpGit2\Test;
 
 use PhpGit2\RepositoryBareTestCase;
 use PhpGit2\Backend\TestRefDbBackend;
+use PhpGit2\Backend\PHPSerializedRefDbBackend;
 use PhpGit2\Callback\CallbackPayload;
 
 final class CustomRefDbBackendTest extends RepositoryBareTestCase {
@@ -61,4 +62,118 @@ final class CustomRefDbBackendTest extends RepositoryBareTestCase {
 
         $this->assertTrue($backend->wasCalled('del'));
     }
+
+    public function testCache() {
+        $backend = new class extends PHPSerializedRefDbBackend {
+            public $lookups = 0;
+
+            public function lookup($refName) {
+                $this->lookups += 1;
+                return parent::lookup($refName);
+            }
+        };
+
+        git2_refdb_backend_set_cache($backend,100);
+        list($repo,$commitId) = $this->makeRepository($backend);
+
+        for ($i = 0;$i < 10;++$i) {
+            git_reference_create($repo,"refs/test/r$i",$commitId,true,"");
+        }
+
+        $lookups = $backend->lookups;
+        $ref = git_reference_lookup($repo,'refs/test/r5');
+        $ref = git_reference_lookup($repo,'refs/test/r5');
+
+        $this->assertSame($commitId,git_reference_target($ref));
+        $this->assertSame($lookups + 1,$backend->lookups);
+
+        // Iterating fills the cache.
+        $callback = function($ref,$payload) {
+
+        };
+        $payload = null;
+        git_reference_foreach($repo,$callback,$payload);
+        $ref = git_reference_lookup($repo,'refs/test/r3');
+        $stats = git2_refdb_backend_cache_stats($backend);
+
+        $this->assertSame($lookups + 1,$backend->lookups);
+        $this->assertSame(100,$stats['capacity']);
+        $this->assertSame(10,$stats['entries']);
+
+        // Deleting through the backend drops the entry.
+        git_reference_delete($ref);
+        $stats = git2_refdb_backend_cache_stats($backend);
+
+        $this->assertSame(9,$stats['entries']);
+
+        git2_refdb_backend_set_cache($backend,0);
+        $stats = git2_refdb_backend_cache_stats($backend);
+
+        $this->assertSame(0,$stats['entries']);
+    }
+
+    public function testIteratorNextBatch() {
+        $backend = new class extends PHPSerializedRefDbBackend {
+            public $batches = [];
+
+            public function iterator_next_batch($count) {
+                $batch = [];
+                while (count($batch) < $count && ($target = $this->iterator_next($name)) !== false) {
+                    $batch[$name] = $target;
+                }
+
+                $this->batches[] = count($batch);
+                return $batch;
+            }
+        };
+
+        list($repo,$commitId) = $this->makeRepository($backend);
+
+        for ($i = 0;$i < 300;++$i) {
+            git_reference_create($repo,"refs/test/r$i",$commitId,true,"");
+        }
+
+        $names = [];
+        $callback = function($name,$payload) use(&$names) {
+            $names[] = $name;
+        };
+        $payload = null;
+        git_reference_foreach_name($repo,$callback,$payload);
+
+        $this->assertCount(300,$names);
+        $this->assertSame('refs/test/r299',$names[299]);
+        $this->assertSame([256,44,0],$backend->batches);
+    }
+
+    private function makeRepository($backend) {
+        $repo = git_repository_new();
+        $odb = git_odb_new();
+        $refdb = git_refdb_new($repo);
+
+        $path = $this->makeDirectory('odb','loose');
+        $loose = git_odb_backend_loose($path,5,false,0700,0600);
+        git_odb_add_backend($odb,$loose,1);
+
+        git_refdb_set_backend($refdb,$backend);
+        git_repository_set_refdb($repo,$refdb);
+        git_repository_set_odb($repo,$odb);
+
+        $builder = git_treebuilder_new($repo,null);
+        $treeId = git_treebuilder_write($builder);
+        git_treebuilder_free($builder);
+
+        $author = git_signature_now('Testing Framework','testing@example.com');
+        $commitId = git_commit_create(
+            $repo,
+            null,
+            $author,
+            $author,
+            null,
+            'This is a test commit for the refdb testing module.',
+            git_tree_lookup($repo,$treeId),
+            []
+        );
+
+        return [$repo,$commitId];
+    }
 }
@@ -515,6 +515,28 @@ EOF;
         $this->assertNull($result);
     }
 
+    /**
+     * @depends testTreeToTree
+     * @phpGitTest git_patch_print
+     */
+    public function testPatchPrint($diff) {
+        $n_line = 0;
+
+        $patch = git_patch_from_diff($diff,0);
+        $printCb = function($delta,$hunk,$line,$payload) use(&$n_line) {
+            $n_line += 1;
+            $this->assertIsArrayOrNull($delta);
+            $this->assertIsArrayOrNull($hunk);
+            $this->assertIsArrayOrNull($line);
+            $this->assertInstanceOf(CallbackPayload::class,$payload);
+        };
+        $payload = new CallbackPayload;
+        $result = git_patch_print($patch,$printCb,$payload);
+
+        $this->assertGreaterThan(0,$n_line);
+        $this->assertNull($result);
+    }
+
     /**
      * @depends testTreeToTree
      * @phpGitTest git_diff_stats_free
@@ -546,6 +568,41 @@ EOF;
         $this->assertIsString($result);
     }
 
+    /**
+     * @depends testTreeToTree
+     * @phpGitTest git2_diff_materialize
+     */
+    public function testMaterialize($diff) {
+        $result = git2_diff_materialize($diff);
+
+        $this->assertIsArray($result);
+        $this->assertCount(git_diff_num_deltas($diff),$result);
+        foreach ($result as $file) {
+            $this->assertIsArray($file['delta']);
+            $this->assertIsBool($file['binary']);
+            foreach ($file['hunks'] as $hunk) {
+                $this->assertIsString($hunk['header']);
+                foreach ($hunk['lines'] as $line) {
+                    $this->assertIsString($line['content']);
+                }
+            }
+        }
+
+        $packed = git2_diff_materialize($diff,GIT2_DIFF_MATERIALIZE_OFFSETS);
+        foreach ($packed as $i => $file) {
+            $this->assertIsString($file['content']);
+            foreach ($file['hunks'] as $j => $hunk) {
+                foreach ($hunk['lines'] as $k => $line) {
+                    list($origin,$oldLineno,$newLineno,$offset,$length) = $line;
+                    $this->assertEquals(
+                        $result[$i]['hunks'][$j]['lines'][$k]['content'],
+                        substr($file['content'],$offset,$length)
+                    );
+                }
+            }
+        }
+    }
+
     /**
      * @phpGitTest git_diff_tree_to_workdir
      */
@@ -102,6 +102,87 @@ final class GeneralTest extends RepositoryTestCase {
         $this->assertIsInt($result);
     }
 
+    /**
+     * @phpGitTest git2_opts_get
+     */
+    public function testOptsGet() {
+        $result = git2_opts_get();
+
+        $this->assertIsArray($result);
+        $this->assertArrayHasKey('mwindow_size',$result);
+        $this->assertIsInt(git2_opts_get('mwindow_mapped_limit'));
+        $this->assertIsBool(git2_opts_get('strict_hash_verification'));
+    }
+
+    /**
+     * @phpGitTest git2_opts_set
+     */
+    public function testOptsSet() {
+        $original = git2_opts_get('mwindow_mapped_limit');
+
+        git2_opts_set('mwindow_mapped_limit',$original * 2);
+        $this->assertEquals($original * 2,git2_opts_get('mwindow_mapped_limit'));
+        git2_opts_set('mwindow_mapped_limit',$original);
+
+        $this->expectException(\Git2Exception::class);
+        git2_opts_set('no_such_option',1);
+    }
+
+    /**
+     * @phpGitTest git2_set_oid_format
+     */
+    public function testSetOidFormat() {
+        $hex = '64db48af90133136eda7414dfd79783a513287a9';
+        $repo = static::getRepository();
+
+        $previous = git2_set_oid_format(GIT2_OID_BINARY);
+        try {
+            $this->assertEquals(GIT2_OID_HEX,$previous);
+
+            $commit = git_commit_lookup($repo,hex2bin($hex));
+            $this->assertEquals(hex2bin($hex),git_commit_id($commit));
+
+            $commit = git_commit_lookup($repo,$hex);
+            $this->assertEquals(20,strlen(git_commit_tree_id($commit)));
+
+            // Prefixes are always hex, even when they are 20 characters long.
+            $commit = git_commit_lookup_prefix($repo,substr($hex,0,20));
+            $this->assertEquals(hex2bin($hex),git_commit_id($commit));
+        } finally {
+            git2_set_oid_format($previous);
+        }
+
+        $this->assertEquals($hex,git_commit_id($commit));
+    }
+
+    /**
+     * @phpGitTest git2_resource_stats
+     */
+    public function testResourceStats() {
+        $repo = static::getRepository();
+        $id = '64db48af90133136eda7414dfd79783a513287a9';
+
+        for ($i = 0;$i < 4;++$i) {
+            $commit = git_commit_lookup($repo,$id);
+            git_commit_free($commit);
+        }
+
+        $result = git2_resource_stats();
+        $this->assertIsArray($result);
+
+        $commitStats = null;
+        foreach ($result as $name => $stats) {
+            if (strpos($name,'git_commit') !== false) {
+                $commitStats = $stats;
+            }
+        }
+
+        $this->assertNotNull($commitStats);
+        $this->assertGreaterThanOrEqual(4,$commitStats['allocs']);
+        $this->assertGreaterThanOrEqual(3,$commitStats['reuses']);
+        $this->assertGreaterThan(0,$commitStats['slabs']);
+    }
+
     public function testExceptionType() {
         $this->assertTrue(class_exists('Git2Exception'));
 
@@ -0,0 +1,111 @@
+<?php
+
+namespace PhpGit2\Test;
+
+use PhpGit2\RepositoryBareTestCase;
+
+final class GraphTest extends RepositoryBareTestCase {
+    /**
+     * @phpGitTest git_graph_ahead_behind
+     */
+    public function testAheadBehind() {
+        $repo = static::getRepository();
+        $local = '64db48af90133136eda7414dfd79783a513287a9';
+        $upstream = 'f6e24b93681d9e30d08b033c5364b7b816681c80';
+        $behind = null;
+        $result = git_graph_ahead_behind($behind,$repo,$local,$upstream);
+
+        $this->assertIsInt($result);
+        $this->assertIsInt($behind);
+        $this->assertGreaterThan(0,$result);
+        $this->assertSame(0,$behind);
+    }
+
+    /**
+     * @phpGitTest git_graph_descendant_of
+     */
+    public function testDescendantOf() {
+        $repo = static::getRepository();
+        $commit = '64db48af90133136eda7414dfd79783a513287a9';
+        $ancestor = 'f6e24b93681d9e30d08b033c5364b7b816681c80';
+
+        $this->assertTrue(git_graph_descendant_of($repo,$commit,$ancestor));
+        $this->assertFalse(git_graph_descendant_of($repo,$ancestor,$commit));
+    }
+
+    /**
+     * @phpGitTest git_graph_reachable_from_any
+     */
+    public function testReachableFromAny() {
+        $repo = static::getRepository();
+        $commit = 'f6e24b93681d9e30d08b033c5364b7b816681c80';
+        $descendants = ['64db48af90133136eda7414dfd79783a513287a9'];
+        $result = git_graph_reachable_from_any($repo,$commit,$descendants);
+
+        $this->assertTrue($result);
+    }
+
+    /**
+     * @phpGitTest git2_graph_ahead_behind_many
+     */
+    public function testAheadBehindMany() {
+        $repo = static::getRepository();
+        $base = 'f6e24b93681d9e30d08b033c5364b7b816681c80';
+        $tips = [
+            'master' => '64db48af90133136eda7414dfd79783a513287a9',
+            'base' => $base,
+        ];
+        $result = git2_graph_ahead_behind_many($repo,$base,$tips);
+
+        $this->assertSame(['master','base'],array_keys($result));
+        $this->assertSame([0,0],$result['base']);
+
+        $behind = null;
+        $ahead = git_graph_ahead_behind($behind,$repo,$tips['master'],$base);
+        $this->assertSame([$ahead,$behind],$result['master']);
+    }
+
+    /**
+     * @phpGitTest git2_graph_ahead_behind_many
+     */
+    public function testAheadBehindManySkewed() {
+        $repo = static::getRepository();
+        $tree = git_tree_lookup($repo,'b962d96869a2e2acf3efd6541670faf7bc58dd11');
+
+        // 'root' is newer than its descendants in the first layout, and all
+        // commits share a time in the second. 'base' merges 'root' and 'side';
+        // 'tip' builds on 'side', so 'root' is reachable from both 'base' and
+        // 'tip'.
+        $layouts = [
+            'skewed' => ['root' => 5000, 'side' => 100, 'base' => 300, 'tip' => 200],
+            'equal' => ['root' => 1000, 'side' => 1000, 'base' => 1000, 'tip' => 1000],
+        ];
+
+        foreach ($layouts as $name => $times) {
+            $make = function($label,array $parents) use($repo,$tree,$times,$name) {
+                $sig = git_signature_new('graph','graph@example.com',$times[$label],0);
+                $parents = array_map(function($id) use($repo) {
+                    return git_commit_lookup($repo,$id);
+                },$parents);
+
+                return git_commit_create($repo,null,$sig,$sig,null,"$name $label",$tree,$parents);
+            };
+
+            $root = $make('root',[]);
+            $side = $make('side',[$root]);
+            $base = $make('base',[$root,$side]);
+            $tip = $make('tip',[$side]);
+
+            $tips = ['tip' => $tip, 'root' => $root, 'side' => $side];
+            $result = git2_graph_ahead_behind_many($repo,$base,$tips);
+
+            foreach ($tips as $key => $id) {
+                $behind = null;
+                $ahead = git_graph_ahead_behind($behind,$repo,$id,$base);
+                $this->assertSame([$ahead,$behind],$result[$key],"$name: $key");
+            }
+
+            $this->assertSame([1,1],$result['tip'],$name);
+        }
+    }
+}
@@ -0,0 +1,85 @@
+<?php
+
+namespace PhpGit2\Test;
+
+use PhpGit2\RepositoryBareTestCase;
+
+final class MidxTest extends RepositoryBareTestCase {
+    /**
+     * @phpGitTest git_midx_writer_new
+     */
+    public function testWriterNew() {
+        $path = static::makePath('repo.git','objects','pack');
+        $result = git_midx_writer_new($path);
+
+        $this->assertResourceHasType($result,'git_midx_writer');
+
+        return $result;
+    }
+
+    /**
+     * @depends testWriterNew
+     * @phpGitTest git_midx_writer_add
+     */
+    public function testWriterAdd($writer) {
+        $packs = glob(static::makePath('repo.git','objects','pack','*.idx'));
+        foreach ($packs as $idx) {
+            $result = git_midx_writer_add($writer,$idx);
+            $this->assertNull($result);
+        }
+
+        return $writer;
+    }
+
+    /**
+     * @depends testWriterAdd
+     * @phpGitTest git_midx_writer_dump
+     */
+    public function testWriterDump($writer) {
+        $result = git_midx_writer_dump($writer);
+
+        $this->assertIsString($result);
+        $this->assertSame('MIDX',substr($result,0,4));
+
+        return $writer;
+    }
+
+    /**
+     * @depends testWriterDump
+     * @phpGitTest git_midx_writer_commit
+     */
+    public function testWriterCommit($writer) {
+        $result = git_midx_writer_commit($writer);
+
+        $this->assertNull($result);
+        $this->assertFileExists(static::makePath('repo.git','objects','pack','multi-pack-index'));
+
+        return $writer;
+    }
+
+    /**
+     * @depends testWriterCommit
+     * @phpGitTest git_midx_writer_free
+     */
+    public function testWriterFree($writer) {
+        $result = git_midx_writer_free($writer);
+
+        $this->assertNull($result);
+        $this->assertResourceHasType($writer,'Unknown');
+    }
+
+    /**
+     * @phpGitTest git2_odb_maintain_midx
+     */
+    public function testMaintainMidx() {
+        $repo = static::getRepository();
+
+        // The test repository has a single pack which is below the default
+        // threshold.
+        $this->assertFalse(git2_odb_maintain_midx($repo));
+
+        @unlink(static::makePath('repo.git','objects','pack','multi-pack-index'));
+        $this->assertTrue(git2_odb_maintain_midx($repo,1));
+        $this->assertFalse(git2_odb_maintain_midx($repo,1));
+    }
+}
@@ -73,6 +73,33 @@ final class ObjectTest extends RepositoryBareTestCase {
         $this->assertIsInt($result);
     }
 
+    /**
+     * @phpGitTest git2_object_lookup_many
+     */
+    public function testLookupMany() {
+        $repo = static::getRepository();
+        $oids = [
+            '64db48af90133136eda7414dfd79783a513287a9',
+            '82a21601e6135604b75a969a3c338ab827bc4d35',
+        ];
+        $result = git2_object_lookup_many($repo,$oids);
+
+        $this->assertCount(2,$result);
+        foreach ($result as $oid => $object) {
+            $this->assertResourceHasType($object,'git_object');
+            $this->assertEquals($oid,git_object_id($object));
+        }
+
+        $result = git2_object_lookup_many($repo,[$oids[0]],GIT_OBJ_COMMIT);
+        $this->assertResourceHasType($result[$oids[0]],'git_commit');
+
+        // Elements that are references are accepted.
+        $byRef = $oids;
+        $alias = &$byRef[1];
+        $result = git2_object_lookup_many($repo,$byRef);
+        $this->assertSame($oids,array_keys($result));
+    }
+
     /**
      * @phpGitTest git_object_lookup_bypath
      */
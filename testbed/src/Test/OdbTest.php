@@ -89,6 +89,56 @@ final class OdbTest extends RepositoryBareTestCase {
         $this->assertNull($result);
     }
 
+    /**
+     *
+     */
+    public function testBackendSqlite() {
+        if (!function_exists('git2_odb_backend_sqlite')) {
+            $this->markTestSkipped('The extension was built without --with-git2-sqlite');
+        }
+
+        $path = static::makePath('odb.sqlite');
+        $backend = git2_odb_backend_sqlite($path);
+
+        $this->assertInstanceOf(\GitODBBackend_Internal::class,$backend);
+
+        $odb = git_odb_new();
+        git_odb_add_backend($odb,$backend,1);
+
+        $data = 'Stored in SQLite';
+        $oid = git_odb_write($odb,$data,GIT_OBJ_BLOB);
+        $object = git_odb_read($odb,$oid);
+
+        $this->assertSame($data,git_odb_object_data($object));
+        $this->assertSame(GIT_OBJ_BLOB,git_odb_object_type($object));
+        $this->assertTrue(git_odb_exists($odb,$oid));
+
+        $size = git_odb_read_header($type,$odb,$oid);
+
+        $this->assertSame(strlen($data),$size);
+        $this->assertSame(GIT_OBJ_BLOB,$type);
+
+        $object = git_odb_read_prefix($odb,substr($oid,0,7));
+
+        $this->assertSame($oid,git_odb_object_id($object));
+        $this->assertSame($oid,git_odb_exists_prefix($odb,substr($oid,0,9)));
+
+        $ids = [];
+        $callback = function($id,$payload) use(&$ids) {
+            $ids[] = $id;
+        };
+        git_odb_foreach($odb,$callback,null);
+
+        $this->assertSame([$oid],$ids);
+
+        // Writes are committed before the call returns, so a second
+        // connection sees them while the first one is still open.
+        $other = git_odb_new();
+        git_odb_add_backend($other,git2_odb_backend_sqlite($path,1000),1);
+
+        $this->assertTrue(git_odb_exists($other,$oid));
+    }
+
     /**
      * @phpGitTest git_odb_backend_one_pack
      */
@@ -567,6 +617,40 @@ final class OdbTest extends RepositoryBareTestCase {
         $this->assertIsInt($type);
     }
 
+    /**
+     * @phpGitTest git2_odb_read_many
+     */
+    public function testReadMany() {
+        $odb = static::getRepoOdb();
+        $oids = [
+            'faf545194b3df246b2b80ce44369371ec9fe2e68',
+            '586818c5f169efa6f847f7e21dfd37859871b85f',
+            'faf545194b3df246b2b80ce44369371ec9fe2e68',
+        ];
+        $result = git2_odb_read_many($odb,$oids);
+
+        $this->assertCount(2,$result);
+        $this->assertSame([$oids[0],$oids[1]],array_keys($result));
+        foreach ($result as $oid => $entry) {
+            $object = git_odb_read($odb,$oid);
+            $this->assertEquals(git_odb_object_data($object),$entry['data']);
+            $this->assertEquals(git_odb_object_type($object),$entry['type']);
+            $this->assertEquals(strlen($entry['data']),$entry['size']);
+        }
+
+        $missing = str_repeat('0',40);
+        $headers = git2_odb_read_many(
+            $odb,
+            array_merge($oids,[$missing]),
+            ['header_only' => true,'ignore_missing' => true]
+        );
+        $this->assertEquals(array_keys($result),array_keys($headers));
+        $this->assertArrayNotHasKey('data',reset($headers));
+
+        $this->expectException(\Git2Exception::class);
+        git2_odb_read_many($odb,[$missing]);
+    }
+
     /**
      * @phpGitTest git_odb_read_prefix
      */
@@ -588,6 +672,69 @@ final class OdbTest extends RepositoryBareTestCase {
         $this->assertNull($result);
     }
 
+    /**
+     * @phpGitTest git_mempack_new
+     */
+    public function testMempackNew() {
+        $result = git_mempack_new();
+
+        $this->assertInstanceOf(\GitODBBackend::class,$result);
+    }
+
+    /**
+     * @phpGitTest git_mempack_dump
+     */
+    public function testMempackDump() {
+        $repo = git_repository_open_bare(static::makePath('repo.git'));
+        $odb = git_repository_odb($repo);
+        $mempack = git_mempack_new();
+        git_odb_add_backend($odb,$mempack,999);
+
+        $id = git_odb_write($odb,'staged in memory',GIT_OBJ_BLOB);
+        $result = git_mempack_dump($repo,$mempack);
+
+        $this->assertIsString($result);
+        $this->assertSame('PACK',substr($result,0,4));
+        $this->assertFileDoesNotExist(
+            static::makePath('repo.git','objects',substr($id,0,2),substr($id,2))
+        );
+
+        return [$repo,$mempack];
+    }
+
+    /**
+     * @depends testMempackDump
+     * @phpGitTest git_mempack_reset
+     */
+    public function testMempackReset($args) {
+        list($repo,$mempack) = $args;
+        $result = git_mempack_reset($mempack);
+
+        $this->assertNull($result);
+    }
+
+    /**
+     * @phpGitTest git_mempack_dump
+     */
+    public function testMempackDump_NotMempack() {
+        $this->expectException(\Exception::class);
+
+        $repo = static::getRepository();
+        $backend = git_odb_backend_pack(static::makePath('repo.git','objects'));
+        git_mempack_dump($repo,$backend);
+    }
+
+    /**
+     * @phpGitTest git_odb_write_multi_pack_index
+     */
+    public function testWriteMultiPackIndex() {
+        $odb = static::getRepoOdb();
+        $result = git_odb_write_multi_pack_index($odb);
+
+        $this->assertNull($result);
+        $this->assertFileExists(static::makePath('repo.git','objects','pack','multi-pack-index'));
+    }
+
     /**
      * @phpGitTest git_odb_write
      */
@@ -183,6 +183,33 @@ final class PackbuilderTest extends RepositoryBareTestCase {
         return $pb;
     }
 
+    /**
+     * @depends testWrite
+     * @phpGitTest git_packbuilder_write_buf
+     */
+    public function testWriteBuf($pb) {
+        $result = git_packbuilder_write_buf($pb);
+
+        $this->assertIsString($result);
+        $this->assertSame('PACK',substr($result,0,4));
+    }
+
+    /**
+     * @depends testWrite
+     */
+    public function testOutput($pb) {
+        $expected = git_packbuilder_write_buf($pb);
+        $stream = static::makeFileStream('output.pack');
+        $result = git2_packbuilder_output($pb,$stream,16);
+
+        $this->assertIsInt($result);
+        $this->assertSame(strlen($expected),$result);
+        $this->assertSame($result,ftell($stream));
+
+        fclose($stream);
+        $this->assertSame($expected,file_get_contents(static::makePath('output.pack')));
+    }
+
     /**
      * @depends testWrite
      * @phpGitTest git_packbuilder_hash
@@ -30,4 +30,36 @@ final class RepositoryBareTest extends RepositoryBareTestCase {
 
         $this->assertNull($result);
     }
+
+    /**
+     * @phpGitTest git2_repository_open_persistent
+     */
+    public function testOpenPersistent() {
+        $path = static::makePath('repo.git');
+        $repo = git2_repository_open_persistent($path);
+
+        $this->assertResourceHasType($repo,'git_repository');
+        $this->assertTrue(git_repository_is_bare($repo));
+
+        $again = git2_repository_open_persistent($path);
+        $this->assertEquals(git_repository_path($repo),git_repository_path($again));
+
+        git_repository_free($repo);
+        $this->assertIsString(git_repository_path($again));
+    }
+
+    /**
+     * @phpGitTest git2_repository_open_persistent
+     */
+    public function testOpenPersistentRefusesBackends() {
+        if (ini_get('git2.persistent_repos') <= 0) {
+            $this->markTestSkipped('The persistent repository pool is disabled');
+        }
+
+        $path = static::makePath('repo.git');
+        $repo = git2_repository_open_persistent($path);
+
+        $this->expectException(\Git2Exception::class);
+        git_repository_set_odb($repo,git_odb_new());
+    }
 }
@@ -119,6 +119,36 @@ final class RevwalkTest extends RepositoryBareTestCase {
         $this->assertFalse($result);
     }
 
+    /**
+     * @phpGitTest git2_revwalk_next_many
+     */
+    public function testNextMany() {
+        $repo = static::getRepository();
+        $start = '64db48af90133136eda7414dfd79783a513287a9';
+
+        $expected = [];
+        $revwalk = git_revwalk_new($repo);
+        git_revwalk_push($revwalk,$start);
+        while (($oid = git_revwalk_next($revwalk)) !== false) {
+            $expected[] = $oid;
+        }
+
+        $actual = [];
+        $revwalk = git_revwalk_new($repo);
+        git_revwalk_push($revwalk,$start);
+        while (($chunk = git2_revwalk_next_many($revwalk,2)) !== false) {
+            $this->assertLessThanOrEqual(2,count($chunk));
+            $actual = array_merge($actual,$chunk);
+        }
+        $this->assertEquals($expected,$actual);
+
+        $revwalk = git_revwalk_new($repo);
+        git_revwalk_push($revwalk,$start);
+        $packed = git2_revwalk_next_many($revwalk,PHP_INT_MAX,true);
+        $this->assertEquals($expected,array_map('bin2hex',str_split($packed,20)));
+        $this->assertFalse(git2_revwalk_next_many($revwalk,1,true));
+    }
+
     /**
      * @phpGitTest git_revwalk_push
      */
@@ -286,6 +286,29 @@ final class TreeTest extends RepositoryBareTestCase {
         $this->assertNull($result);
     }
 
+    /**
+     * @depends testLookup
+     * @phpGitTest git2_tree_list
+     */
+    public function testList($tree) {
+        $n = 0;
+        $callback = function($root,$entry) use(&$n) {
+            $n += 1;
+        };
+        git_tree_walk($tree,GIT_TREEWALK_PRE,$callback,null);
+
+        $result = git2_tree_list($tree);
+
+        $this->assertCount($n,$result);
+        $this->assertSame(['path','mode','type','id'],array_keys($result[0]));
+
+        $result = git2_tree_list($tree,GIT2_TREE_LIST_COLUMNAR,null,0);
+
+        $this->assertSame(['path','mode','type','id'],array_keys($result));
+        $this->assertCount(git_tree_entrycount($tree),$result['path']);
+        $this->assertCount(count($result['path']),$result['id']);
+    }
+
     /**
      * @phpGitTest git_tree_lookup_prefix
      */
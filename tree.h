@@ -51,6 +51,172 @@ namespace php_git2
         }
     };
 
+    // Provides the state for git2_tree_list(). The tree is walked in C and each
+    // entry is appended to the result without calling into userspace.
+
+    class php_git2_tree_lister
+    {
+    public:
+        php_git2_tree_lister(zval* result,zend_long flags,zend_long maxDepth):
+            columnar((flags & GIT2_TREE_LIST_COLUMNAR) != 0),
+            blobsOnly((flags & GIT2_TREE_LIST_BLOBS_ONLY) != 0),
+            depthLimit(maxDepth), base(nullptr), baseLength(0), list(result)
+        {
+            if (columnar) {
+                static const char* const COLUMNS[] = { "path", "mode", "type", "id" };
+
+                array_init_size(result,4);
+                for (int i = 0;i < 4;++i) {
+                    zval zcolumn;
+
+                    array_init(&zcolumn);
+                    columns[i] = zend_hash_str_add_new(Z_ARRVAL_P(result),
+                        COLUMNS[i],
+                        strlen(COLUMNS[i]),
+                        &zcolumn);
+                }
+            }
+            else {
+                array_init(result);
+            }
+        }
+
+        void walk(git_tree* tree,const char* prefix,size_t prefixLength)
+        {
+            int retval;
+
+            base = prefix;
+            baseLength = prefixLength;
+
+            retval = git_tree_walk(tree,GIT_TREEWALK_PRE,callback,this);
+            if (retval < 0) {
+                git_error(retval);
+            }
+        }
+
+    private:
+        static int callback(const char* root,const git_tree_entry* entry,void* payload)
+        {
+            php_git2_tree_lister* lister = reinterpret_cast<php_git2_tree_lister*>(payload);
+            const char* name = git_tree_entry_name(entry);
+            size_t rootLength = strlen(root);
+            size_t nameLength = strlen(name);
+            git_otype type = git_tree_entry_type(entry);
+            zend_long depth = 0;
+
+            // The depth of the entry is the number of components in its root
+            // path (which always has a trailing separator when non-empty).
+            for (size_t i = 0;i < rootLength;++i) {
+                if (root[i] == '/') {
+                    depth += 1;
+                }
+            }
+
+            if (!lister->blobsOnly || type != GIT_OBJ_TREE) {
+                zend_string* path;
+                char* p;
+                zval zv;
+
+                path = zend_string_alloc(lister->baseLength + rootLength + nameLength,0);
+                p = ZSTR_VAL(path);
+                memcpy(p,lister->base,lister->baseLength);
+                p += lister->baseLength;
+                memcpy(p,root,rootLength);
+                p += rootLength;
+                memcpy(p,name,nameLength);
+                p[nameLength] = 0;
+
+                if (lister->columnar) {
+                    ZVAL_STR(&zv,path);
+                    add_next_index_zval(lister->columns[0],&zv);
+                    add_next_index_long(lister->columns[1],git_tree_entry_filemode(entry));
+                    add_next_index_long(lister->columns[2],type);
+                    convert_oid(&zv,git_tree_entry_id(entry));
+                    add_next_index_zval(lister->columns[3],&zv);
+                }
+                else {
+                    convert_tree_list_entry(&zv,path,entry);
+                    add_next_index_zval(lister->list,&zv);
+                }
+            }
+
+            // Returning a positive value skips the subtree of a tree entry.
+            if (type == GIT_OBJ_TREE && lister->depthLimit >= 0 && depth >= lister->depthLimit) {
+                return 1;
+            }
+
+            return 0;
+        }
+
+        bool columnar;
+        bool blobsOnly;
+        zend_long depthLimit;
+        const char* base;
+        size_t baseLength;
+        zval* list;
+        zval* columns[4];
+    };
+
+    // Implements git2_tree_list(). If a prefix is provided, then only the
+    // subtree at that path is walked.
+
+    inline void php_git2_tree_list(zval* return_value,
+        git_tree* tree,
+        zend_long flags,
+        const char* prefix,
+        size_t prefixLength,
+        zend_long maxDepth)
+    {
+        php_git2_tree_lister lister(return_value,flags,maxDepth);
+
+        // Normalize the prefix so that it has no leading or trailing
+        // separators.
+        while (prefixLength > 0 && *prefix == '/') {
+            prefix += 1;
+            prefixLength -= 1;
+        }
+        while (prefixLength > 0 && prefix[prefixLength-1] == '/') {
+            prefixLength -= 1;
+        }
+
+        if (prefixLength == 0) {
+            lister.walk(tree,"",0);
+            return;
+        }
+
+        int retval;
+        git_tree_entry* entry;
+        git_tree* subtree;
+        std::string path(prefix,prefixLength);
+
+        retval = git_tree_entry_bypath(&entry,tree,path.c_str());
+        if (retval < 0) {
+            git_error(retval);
+        }
+
+        if (git_tree_entry_type(entry) != GIT_OBJ_TREE) {
+            git_tree_entry_free(entry);
+            throw php_git2_error_exception("Path '%s' does not name a tree",path.c_str());
+        }
+
+        retval = git_tree_lookup(&subtree,git_tree_owner(tree),git_tree_entry_id(entry));
+        git_tree_entry_free(entry);
+        if (retval < 0) {
+            git_error(retval);
+        }
+
+        path.push_back('/');
+
+        try {
+            lister.walk(subtree,path.c_str(),path.length());
+        } catch (...) {
+            git_tree_free(subtree);
+            throw;
+        }
+
+        git_tree_free(subtree);
+    }
+
 } // namespace php_git2
 
 // Template declarations for bindings:
@@ -102,8 +268,8 @@ static constexpr auto ZIF_GIT_TREE_LOOKUP_PREFIX = zif_php_git2_function_setdeps
         php_git2::php_resource_ref<php_git2::php_git_tree>,
         php_git2::php_resource<php_git2::php_git_repository>,
         php_git2::connector_wrapper<php_git2::php_string_length_connector<
-                                        size_t,php_git2::php_git_oid_fromstr> >,
-        php_git2::php_git_oid_fromstr
+                                        size_t,php_git2::php_git_oid_prefix_fromhex> >,
+        php_git2::php_git_oid_prefix_fromhex
         >,
     php_git2::sequence<0,1>,
     1,
@@ -332,6 +498,46 @@ static constexpr auto ZIF_GIT_TREE_WALK = zif_php_git2_function<
     php_git2::sequence<0,1,2,3>
     >;
 
+static PHP_FUNCTION(git2_tree_list)
+{
+    php_git2::php_bailer bailer;
+
+    {
+        php_git2::php_resource<php_git2::php_git_tree> tree;
+        php_git2::php_bailout_context ctx(bailer);
+
+        if (BAILOUT_ENTER_REGION(ctx)) {
+            zval* ztree;
+            zend_long flags = 0;
+            char* prefix = nullptr;
+            size_t prefixLength = 0;
+            zend_long maxDepth = -1;
+            if (zend_parse_parameters(ZEND_NUM_ARGS(),"z|ls!l",&ztree,&flags,
+                    &prefix,&prefixLength,&maxDepth) == FAILURE)
+            {
+                return;
+            }
+
+            try {
+                tree.parse(ztree,1);
+                php_git2::php_git2_tree_list(return_value,
+                    tree.byval_git2(),
+                    flags,
+                    prefix != nullptr ? prefix : "",
+                    prefixLength,
+                    maxDepth);
+
+            } catch (php_git2::php_git2_exception_base& ex) {
+                php_git2::php_bailout_context ctx2(bailer);
+
+                if (BAILOUT_ENTER_REGION(ctx2)) {
+                    ex.handle();
+                }
+            }
+        }
+    }
+}
+
 // PHP function entry macro for this module:
 
 #define GIT_TREE_FE                                                     \
@@ -355,7 +561,8 @@ static constexpr auto ZIF_GIT_TREE_WALK = zif_php_git2_function<
     PHP_GIT2_FE(git_tree_entry_cmp,ZIF_GIT_TREE_ENTRY_CMP,NULL)         \
     PHP_GIT2_FE(git_tree_entry_id,ZIF_GIT_TREE_ENTRY_ID,NULL)           \
     PHP_GIT2_FE(git_tree_entry_type,ZIF_GIT_TREE_ENTRY_TYPE,NULL)       \
-    PHP_GIT2_FE(git_tree_walk,ZIF_GIT_TREE_WALK,NULL)
+    PHP_GIT2_FE(git_tree_walk,ZIF_GIT_TREE_WALK,NULL)                   \
+    PHP_FE(git2_tree_list,NULL)
 
 #endif
 